@@ -0,0 +1,226 @@
+#!/usr/bin/env python3
+"""
+Benchmark runner for the arboretum solvers.
+
+Runs each entry of a suite file (solver, mode, instance, extra arguments)
+several times using the release binaries, records wall time, nodes,
+nodes/second and peak RSS, writes the results as JSON and compares them
+against a stored baseline. Exits non-zero if any run regressed by more than
+the threshold, so it can gate new builds.
+
+Instances are read from the instance directory, or made by the generator
+from the arguments listed under "generated" in the suite (seeded, so the
+same graph every time). Entries should run for about a second: much shorter
+ones are not judged.
+
+    ./bench.py                          # run suite.json, compare to baseline.json
+    ./bench.py --only vertex-color      # subset of runs
+    ./bench.py --save-baseline          # accept the current results
+"""
+
+import argparse
+import datetime
+import json
+import os
+import pathlib
+import platform
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+base = pathlib.Path(__file__).parent.resolve()
+arboretum = base.parent
+
+
+def run_name(run):
+    return " ".join(
+        [run["solver"], run["mode"], run["instance"]] + run.get("args", []))
+
+
+def read_report(report_file):
+    """ Last line of a JSON report written by --report. """
+    with open(report_file) as infile:
+        lines = [line for line in infile if line.strip()]
+    return json.loads(lines[-1]) if lines else None
+
+
+def generate_instances(generated, names, directory):
+    """ Write the generated instances among names to directory. """
+    binary = arboretum.joinpath("generate", "bin", "main")
+    for name in names:
+        command = [str(binary)] + generated[name] + ["--output", str(directory.joinpath(name))]
+        process = subprocess.run(command, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE)
+        if process.returncode != 0:
+            raise RuntimeError(f"generating {name} failed: {process.stderr.decode()}")
+
+
+def run_once(run, instances):
+    """ Solve once, returning wall time, peak RSS and the solver's report. """
+    binary = arboretum.joinpath(run["solver"], "bin", "main")
+    command = [str(binary), str(instances(run["instance"])),
+               "--mode", run["mode"]] + run.get("args", [])
+    with tempfile.TemporaryDirectory() as tmp:
+        report_file = pathlib.Path(tmp).joinpath("report.json")
+        # Only backtrack mode keeps statistics and writes JSON (recursion and
+        # best-first reject it), so only wall time is available for others.
+        if run["mode"] == "backtrack":
+            command += ["--log-format", "json", "--report", str(report_file)]
+        start = time.perf_counter()
+        process = subprocess.Popen(
+            command, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE)
+        _, status, usage = os.wait4(process.pid, 0)
+        wall_time = time.perf_counter() - start
+        process.returncode = os.waitstatus_to_exitcode(status)
+        if process.returncode != 0:
+            raise RuntimeError(
+                f"{run_name(run)} failed: {process.stderr.read().decode()}")
+        report = read_report(report_file) if report_file.exists() else None
+    # ru_maxrss is in kilobytes on Linux.
+    return wall_time, usage.ru_maxrss, report
+
+
+def run_benchmark(run, instances, repeats):
+    wall_times, solve_times, rss, nodes = [], [], [], set()
+    status = None
+    for _ in range(repeats):
+        wall_time, peak_rss, report = run_once(run, instances)
+        wall_times.append(wall_time)
+        rss.append(peak_rss)
+        if report is not None:
+            solve_times.append(report["time"])
+            nodes.add(report["nodes"])
+            status = report["status"]
+    if len(nodes) > 1:
+        print(f"  warning: node counts differ between repeats: {sorted(nodes)}")
+    result = {
+        "name": run_name(run),
+        "repeats": repeats,
+        "wall_time": statistics.median(wall_times),
+        "wall_time_min": min(wall_times),
+        "wall_time_max": max(wall_times),
+        "peak_rss_kb": max(rss),
+        "status": status,
+        "solve_time": statistics.median(solve_times) if solve_times else None,
+        "nodes": max(nodes) if nodes else None,
+        "nodes_per_second": None,
+    }
+    if nodes and statistics.median(solve_times) > 0:
+        result["nodes_per_second"] = max(nodes) / statistics.median(solve_times)
+    return result
+
+
+def compare(results, baseline, threshold, min_time):
+    """ Print a comparison table and return the names of regressed runs.
+    Runs which took less than min_time seconds (in the solver where it
+    reports its time, since reading the instance is not part of the search)
+    are shown but not judged, as timer and startup noise dominates them. """
+    previous = {result["name"]: result for result in baseline["results"]}
+    regressions = []
+    print(f"{'run':<60} {'metric':>10} {'baseline':>12} {'current':>12} {'change':>8}")
+    for result in results:
+        old = previous.get(result["name"])
+        if old is None:
+            print(f"{result['name']:<60} {'(new)':>10}")
+            continue
+        # Throughput where the solver counts nodes, otherwise wall time.
+        if result["nodes_per_second"] and old.get("nodes_per_second"):
+            metric, now, then = "nodes/s", result["nodes_per_second"], old["nodes_per_second"]
+            change = now / then - 1
+            regressed = change < -threshold
+        else:
+            metric, now, then = "wall", result["wall_time"], old["wall_time"]
+            change = now / then - 1
+            regressed = change > threshold
+        if min(duration(result), duration(old)) < min_time:
+            regressed = False
+            flag = "  (too short to judge)"
+        else:
+            flag = "  REGRESSION" if regressed else ""
+        print(f"{result['name']:<60} {metric:>10} {then:>12.4g} {now:>12.4g} {change:>+8.1%}{flag}")
+        if result["nodes"] != old.get("nodes"):
+            print(f"  note: nodes changed {old.get('nodes')} -> {result['nodes']} (search differs)")
+        if regressed:
+            regressions.append(result["name"])
+    return regressions
+
+
+def duration(result):
+    return result["solve_time"] if result.get("solve_time") else result["wall_time"]
+
+
+def git_commit():
+    try:
+        return subprocess.run(
+            ["git", "rev-parse", "--short", "HEAD"], cwd=base,
+            capture_output=True, text=True, check=True).stdout.strip()
+    except (OSError, subprocess.CalledProcessError):
+        return None
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Arboretum benchmark runner.")
+    parser.add_argument("--suite", type=pathlib.Path, default=base.joinpath("suite.json"))
+    parser.add_argument("--instances", type=pathlib.Path,
+                        default=arboretum.parent.joinpath("instances", "graphs"))
+    parser.add_argument("--repeats", type=int, help="Override the suite's repeat count.")
+    parser.add_argument("--only", help="Only run entries whose name contains this text.")
+    parser.add_argument("--output", type=pathlib.Path, default=base.joinpath("results.json"))
+    parser.add_argument("--baseline", type=pathlib.Path, default=base.joinpath("baseline.json"))
+    parser.add_argument("--threshold", type=float, default=0.10,
+                        help="Relative slowdown counted as a regression.")
+    parser.add_argument("--min-time", type=float, default=0.1,
+                        help="Runs shorter than this (seconds) are not judged.")
+    parser.add_argument("--save-baseline", action="store_true",
+                        help="Write the results to the baseline file.")
+    args = parser.parse_args()
+
+    with open(args.suite) as infile:
+        suite = json.load(infile)
+    repeats = args.repeats or suite.get("repeats", 3)
+    runs = [run for run in suite["runs"] if not args.only or args.only in run_name(run)]
+
+    generated = suite.get("generated", {})
+    results = []
+    with tempfile.TemporaryDirectory() as tmp:
+        directory = pathlib.Path(tmp)
+        generate_instances(
+            generated, sorted({run["instance"] for run in runs} & generated.keys()), directory)
+
+        def instances(name):
+            return (directory if name in generated else args.instances).joinpath(name)
+
+        for run in runs:
+            print(f"Running {run_name(run)} x{repeats}", flush=True)
+            results.append(run_benchmark(run, instances, repeats))
+
+    output = {
+        "commit": git_commit(),
+        "date": datetime.datetime.now().isoformat(timespec="seconds"),
+        "host": platform.node(),
+        "cpus": os.cpu_count(),
+        "results": results,
+    }
+    with open(args.output, "w") as outfile:
+        json.dump(output, outfile, indent=4)
+    print(f"Results written to {args.output}")
+
+    if args.save_baseline:
+        with open(args.baseline, "w") as outfile:
+            json.dump(output, outfile, indent=4)
+        print(f"Baseline written to {args.baseline}")
+    elif args.baseline.exists():
+        with open(args.baseline) as infile:
+            baseline = json.load(infile)
+        print(f"Comparing against baseline {baseline.get('commit')} ({baseline.get('date')})")
+        regressions = compare(results, baseline, args.threshold, args.min_time)
+        if regressions:
+            print(f"{len(regressions)} regression(s) over {args.threshold:.0%}")
+            sys.exit(1)
+    else:
+        print(f"No baseline at {args.baseline}; run with --save-baseline to create one.")
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,82 @@
+#ifndef SRC_GENERATE_GENERATORS_HPP_
+#define SRC_GENERATE_GENERATORS_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+// Random source which gives the same sequence on every platform for a given
+// seed. The standard distributions are implementation-defined, so values
+// are drawn directly from the (fully specified) mt19937_64 engine.
+class Random {
+    std::mt19937_64 engine;
+public:
+    explicit Random(uint64_t seed) : engine(seed) {}
+    // Uniform integer in [0, n).
+    uint64_t below(uint64_t n);
+    // Uniform real in [0, 1).
+    double real() { return (engine() >> 11) * 0x1.0p-53; }
+    bool chance(double p) { return real() < p; }
+    // k distinct values from [0, n), in random order.
+    std::vector<unsigned> sample(unsigned n, unsigned k);
+};
+
+
+// Generated graph as a sorted list of edges (i, j) with i < j and no
+// repeats, with the hidden clique of the brock and planted families.
+struct EdgeListGraph {
+    unsigned vertices = 0;
+    std::vector<std::pair<unsigned, unsigned>> edges;
+    std::vector<unsigned> planted;
+
+    void add(unsigned i, unsigned j) {
+        edges.emplace_back(std::min(i, j), std::max(i, j));
+    }
+    // Sort edges and remove repeats.
+    void finish();
+};
+
+
+// Erdos-Renyi G(n, p): each edge independently with probability p. Runs in
+// O(n + m) by skipping geometrically distributed runs of non-edges.
+EdgeListGraph generate_gnp(unsigned n, double p, Random& random);
+// Erdos-Renyi G(n, m): m distinct edges chosen uniformly.
+EdgeListGraph generate_gnm(unsigned n, uint64_t m, Random& random);
+// G(n, p) with a clique on k random vertices added.
+EdgeListGraph generate_planted(unsigned n, double p, unsigned k, Random& random);
+// Brockington-Culberson style hidden clique (DIMACS brock family): a clique
+// on k random vertices whose other edges are made less likely, so clique
+// vertices have the same expected degree p(n - 1) as the rest.
+EdgeListGraph generate_brock(unsigned n, double p, unsigned k, Random& random);
+// Soriano-Gendreau generator (DIMACS p_hat family): vertex i draws a density
+// d_i uniformly from [a, b] and edge ij appears with probability
+// (d_i + d_j) / 2, giving a wide spread of degrees.
+EdgeListGraph generate_phat(unsigned n, double a, double b, Random& random);
+// Hamming graph (DIMACS hamming family): the words of the given number of
+// bits, adjacent if they differ in at least d bits.
+EdgeListGraph generate_hamming(unsigned bits, unsigned d);
+// Keller graph of dimension d: the 4^d words over {0, 1, 2, 3}, adjacent if
+// they differ in at least two positions, in at least one of which by exactly
+// 2 (mod 4). DIMACS kellerN instances are smaller graphs derived from these.
+EdgeListGraph generate_keller(unsigned d);
+// Mycielski graphs (DIMACS mycielK): triangle-free with chromatic number
+// k + 1, built by applying the Mycielskian k - 1 times to K2.
+EdgeListGraph generate_mycielski(unsigned k);
+// Caramia and Dell'Olmo's k-Insertions_m and k-FullIns_m coloring families:
+// m - 1 applications to K2 of the generalised Mycielskian with k + 1 levels
+// of copies. FullIns adds an apex for every level of copies besides the
+// usual one, the apexes forming a clique.
+EdgeListGraph generate_insertions(unsigned k, unsigned m, bool full);
+
+// Write in the DIMACS format read by UndirectedGraph::read_dimacs, with
+// vertices numbered from 1. Comment lines are written first.
+void write_dimacs(
+    std::ostream& out, const EdgeListGraph& graph,
+    const std::vector<std::string>& comments = {});
+
+#endif  // SRC_GENERATE_GENERATORS_HPP_
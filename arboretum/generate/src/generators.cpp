@@ -0,0 +1,277 @@
+#include <charconv>
+#include <cmath>
+#include <limits>
+#include <unordered_set>
+
+#include <gsl/gsl_assert>
+
+#include "../include/generators.hpp"
+
+using namespace std;
+
+
+uint64_t Random::below(uint64_t n) {
+    Expects(n > 0);
+    // Reject the top partial block of values to avoid modulo bias.
+    const uint64_t limit = numeric_limits<uint64_t>::max()
+        - numeric_limits<uint64_t>::max() % n;
+    uint64_t value;
+    do { value = engine(); } while (value >= limit);
+    return value % n;
+}
+
+
+vector<unsigned> Random::sample(unsigned n, unsigned k) {
+    Expects(k <= n);
+    // Partial Fisher-Yates shuffle.
+    vector<unsigned> values(n);
+    for (unsigned i = 0; i < n; i++) { values[i] = i; }
+    for (unsigned i = 0; i < k; i++) {
+        swap(values[i], values[i + below(n - i)]);
+    }
+    values.resize(k);
+    return values;
+}
+
+
+void EdgeListGraph::finish() {
+    sort(begin(edges), end(edges));
+    edges.erase(unique(begin(edges), end(edges)), end(edges));
+}
+
+
+EdgeListGraph generate_gnp(unsigned n, double p, Random& random) {
+    Expects(p >= 0 && p <= 1);
+    EdgeListGraph graph;
+    graph.vertices = n;
+    if (p == 0) { return graph; }
+    graph.edges.reserve(static_cast<size_t>(p * n * (n - 1.0) / 2 * 1.01));
+    if (p == 1) {
+        for (unsigned j = 1; j < n; j++) {
+            for (unsigned i = 0; i < j; i++) { graph.add(i, j); }
+        }
+    } else {
+        // Batagelj and Brandes: walk the pairs (w, v), w < v, row by row,
+        // skipping a geometric number of non-edges each step.
+        const double log_q = log(1 - p);
+        int64_t v = 1, w = -1;
+        while (v < n) {
+            w += 1 + static_cast<int64_t>(floor(log(1 - random.real()) / log_q));
+            while (w >= v && v < n) {
+                w -= v;
+                v++;
+            }
+            if (v < n) { graph.add(w, v); }
+        }
+    }
+    graph.finish();
+    return graph;
+}
+
+
+EdgeListGraph generate_gnm(unsigned n, uint64_t m, Random& random) {
+    const uint64_t pairs = static_cast<uint64_t>(n) * (n - 1) / 2;
+    Expects(m <= pairs);
+    // Sample whichever of the edges or non-edges is the smaller set.
+    const bool complement = m > pairs / 2;
+    const uint64_t count = complement ? pairs - m : m;
+    unordered_set<uint64_t> chosen;
+    chosen.reserve(count);
+    while (chosen.size() < count) {
+        uint64_t i = random.below(n), j = random.below(n);
+        if (i == j) { continue; }
+        chosen.insert(min(i, j) * n + max(i, j));
+    }
+    EdgeListGraph graph;
+    graph.vertices = n;
+    graph.edges.reserve(m);
+    if (complement) {
+        for (unsigned i = 0; i < n; i++) {
+            for (unsigned j = i + 1; j < n; j++) {
+                if (chosen.count(static_cast<uint64_t>(i) * n + j) == 0) { graph.add(i, j); }
+            }
+        }
+    } else {
+        for (uint64_t key : chosen) { graph.add(key / n, key % n); }
+    }
+    graph.finish();
+    return graph;
+}
+
+
+EdgeListGraph generate_planted(unsigned n, double p, unsigned k, Random& random) {
+    auto graph = generate_gnp(n, p, random);
+    graph.planted = random.sample(n, k);
+    sort(begin(graph.planted), end(graph.planted));
+    for (unsigned a = 0; a < k; a++) {
+        for (unsigned b = a + 1; b < k; b++) {
+            graph.add(graph.planted[a], graph.planted[b]);
+        }
+    }
+    graph.finish();
+    return graph;
+}
+
+
+EdgeListGraph generate_brock(unsigned n, double p, unsigned k, Random& random) {
+    Expects(k <= n && p >= 0 && p <= 1);
+    EdgeListGraph graph;
+    graph.vertices = n;
+    graph.planted = random.sample(n, k);
+    sort(begin(graph.planted), end(graph.planted));
+    vector<bool> hidden(n, false);
+    for (unsigned v : graph.planted) { hidden[v] = true; }
+    // Clique vertices get k - 1 edges from the clique, so their other edges
+    // are drawn with a probability leaving the expected degree unchanged.
+    double p_hidden = (k < n) ? (p * (n - 1.0) - (k - 1.0)) / (n - k) : 0;
+    p_hidden = min(max(p_hidden, 0.0), 1.0);
+    for (unsigned i = 0; i < n; i++) {
+        for (unsigned j = i + 1; j < n; j++) {
+            bool edge;
+            if (hidden[i] && hidden[j]) {
+                edge = true;
+            } else if (hidden[i] || hidden[j]) {
+                edge = random.chance(p_hidden);
+            } else {
+                edge = random.chance(p);
+            }
+            if (edge) { graph.edges.emplace_back(i, j); }
+        }
+    }
+    return graph;
+}
+
+
+EdgeListGraph generate_phat(unsigned n, double a, double b, Random& random) {
+    Expects(a >= 0 && a <= b && b <= 1);
+    EdgeListGraph graph;
+    graph.vertices = n;
+    vector<double> density(n);
+    for (auto& d : density) { d = a + (b - a) * random.real(); }
+    for (unsigned i = 0; i < n; i++) {
+        for (unsigned j = i + 1; j < n; j++) {
+            if (random.chance((density[i] + density[j]) / 2)) {
+                graph.edges.emplace_back(i, j);
+            }
+        }
+    }
+    return graph;
+}
+
+
+EdgeListGraph generate_hamming(unsigned bits, unsigned d) {
+    Expects(bits < 32);
+    EdgeListGraph graph;
+    graph.vertices = 1u << bits;
+    for (unsigned i = 0; i < graph.vertices; i++) {
+        for (unsigned j = i + 1; j < graph.vertices; j++) {
+            if (static_cast<unsigned>(__builtin_popcount(i ^ j)) >= d) {
+                graph.edges.emplace_back(i, j);
+            }
+        }
+    }
+    return graph;
+}
+
+
+EdgeListGraph generate_keller(unsigned d) {
+    Expects(d > 0 && d < 16);
+    EdgeListGraph graph;
+    graph.vertices = 1u << (2 * d);
+    // Words are stored two bits per position.
+    for (unsigned i = 0; i < graph.vertices; i++) {
+        for (unsigned j = i + 1; j < graph.vertices; j++) {
+            unsigned differ = 0;
+            bool by_two = false;
+            for (unsigned pos = 0; pos < d; pos++) {
+                unsigned x = (i >> (2 * pos)) & 3, y = (j >> (2 * pos)) & 3;
+                if (x != y) { differ++; }
+                if (((x - y) & 3) == 2) { by_two = true; }
+            }
+            if (differ >= 2 && by_two) { graph.edges.emplace_back(i, j); }
+        }
+    }
+    return graph;
+}
+
+
+// Generalised Mycielskian: the graph (level 0) with copies of its vertices
+// at levels 1..levels, each copy adjacent to the previous level's copies of
+// its neighbours, and an apex adjacent to the top level. With full set each
+// level above 0 also gets an apex of its own, and all the apexes form a
+// clique.
+EdgeListGraph mycielskian(const EdgeListGraph& base, unsigned levels, bool full) {
+    const unsigned n = base.vertices;
+    const unsigned apex = n * (levels + 1);
+    EdgeListGraph graph;
+    graph.vertices = apex + (full ? levels + 1 : 1);
+    graph.edges.reserve(base.edges.size() * (2 * levels + 1) + n * (levels + 1)
+                        + levels * (levels + 1) / 2);
+    graph.edges.insert(end(graph.edges), begin(base.edges), end(base.edges));
+    for (unsigned l = 1; l <= levels; l++) {
+        for (auto [i, j] : base.edges) {
+            graph.add(l * n + i, (l - 1) * n + j);
+            graph.add(l * n + j, (l - 1) * n + i);
+        }
+    }
+    // The apex adjacent to the top level is numbered last.
+    const unsigned top = graph.vertices - 1;
+    for (unsigned v = 0; v < n; v++) { graph.add(levels * n + v, top); }
+    if (full) {
+        for (unsigned l = 1; l <= levels; l++) {
+            for (unsigned v = 0; v < n; v++) { graph.add(l * n + v, apex + l - 1); }
+        }
+        for (unsigned a = apex; a <= top; a++) {
+            for (unsigned b = a + 1; b <= top; b++) { graph.add(a, b); }
+        }
+    }
+    graph.finish();
+    return graph;
+}
+
+
+EdgeListGraph generate_mycielski(unsigned k) {
+    return generate_insertions(0, k, false);
+}
+
+
+EdgeListGraph generate_insertions(unsigned k, unsigned m, bool full) {
+    Expects(m > 0);
+    EdgeListGraph graph;
+    graph.vertices = 2;
+    graph.add(0, 1);
+    for (unsigned step = 1; step < m; step++) {
+        graph = mycielskian(graph, k + 1, full);
+    }
+    return graph;
+}
+
+
+void write_dimacs(
+        ostream& out, const EdgeListGraph& graph, const vector<string>& comments) {
+    for (const auto& comment : comments) { out << "c " << comment << "\n"; }
+    if (!graph.planted.empty()) {
+        out << "c planted clique:";
+        for (unsigned v : graph.planted) { out << " " << v + 1; }
+        out << "\n";
+    }
+    out << "p edge " << graph.vertices << " " << graph.edges.size() << "\n";
+    // Formatted by hand into a buffer: large graphs have millions of lines.
+    constexpr size_t flush_size = 1 << 20;
+    vector<char> buffer(flush_size + 64);
+    char* position = buffer.data();
+    for (auto [i, j] : graph.edges) {
+        *position++ = 'e';
+        *position++ = ' ';
+        position = to_chars(position, position + 16, i + 1).ptr;
+        *position++ = ' ';
+        position = to_chars(position, position + 16, j + 1).ptr;
+        *position++ = '\n';
+        if (static_cast<size_t>(position - buffer.data()) >= flush_size) {
+            out.write(buffer.data(), position - buffer.data());
+            position = buffer.data();
+        }
+    }
+    out.write(buffer.data(), position - buffer.data());
+    out.flush();
+}
@@ -0,0 +1,156 @@
+#include <charconv>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <cxxopts.hpp>
+
+#include <arbory/struct/graph.hpp>
+
+#include "../include/generators.hpp"
+
+using namespace std;
+
+
+// Shortest text that reads back as the same value (to_string rounds
+// doubles to six decimals).
+template <typename T>
+string exact_string(T value) {
+    if constexpr (is_floating_point_v<T>) {
+        char buffer[32];
+        auto last = to_chars(begin(buffer), end(buffer), value).ptr;
+        return string(buffer, last);
+    } else {
+        return to_string(value);
+    }
+}
+
+
+int main(int argc, char **argv) {
+    cxxopts::Options options(
+        "Arbory Graph Generator",
+        "Seeded random and structured graph families in DIMACS or binary format");
+    options.add_options()
+        ("family", "gnp, gnm, planted, brock, phat, hamming, keller, mycielski, "
+                   "insertions or fullins; or convert to read --input",
+         cxxopts::value<string>())
+        ("i,input", "Graph File To Convert (DIMACS or binary)", cxxopts::value<string>())
+        ("n,vertices", "Vertices", cxxopts::value<unsigned>())
+        ("p,density", "Edge Probability", cxxopts::value<double>())
+        ("m,edges", "Edges (gnm)", cxxopts::value<uint64_t>())
+        ("k,clique", "Hidden Clique Size (planted, brock)", cxxopts::value<unsigned>())
+        ("density-min", "Minimum Vertex Density (phat)", cxxopts::value<double>())
+        ("density-max", "Maximum Vertex Density (phat)", cxxopts::value<double>())
+        ("bits", "Word Length (hamming)", cxxopts::value<unsigned>())
+        ("distance", "Minimum Hamming Distance Of Adjacent Words", cxxopts::value<unsigned>())
+        ("dimension", "Dimension (keller)", cxxopts::value<unsigned>())
+        ("order", "Order (mycielski, insertions, fullins)", cxxopts::value<unsigned>())
+        ("insertions", "Inserted Levels (insertions, fullins)", cxxopts::value<unsigned>())
+        ("s,seed", "Random Seed", cxxopts::value<uint64_t>()->default_value("1"))
+        ("o,output", "Output File (default: standard output)", cxxopts::value<string>())
+        ("format", "Output Format (dimacs/binary)", cxxopts::value<string>()->default_value("dimacs"))
+        ("matrix", "Store Bit Matrix In Binary Output (auto/always/never)",
+         cxxopts::value<string>()->default_value("auto"))
+        ;
+    options.parse_positional({"family"});
+    auto result = options.parse(argc, argv);
+    if (!result.count("family")) {
+        cerr << options.help() << endl;
+        return 1;
+    }
+    // Parameters are echoed into the file header so it can be regenerated.
+    vector<string> parameters;
+    auto get = [&result, &parameters](const string& name, auto type) {
+        using T = decltype(type);
+        if (!result.count(name)) {
+            throw domain_error("Option --" + name + " is required for this family.");
+        }
+        auto value = result[name].as<T>();
+        parameters.push_back("--" + name + "=" + exact_string(value));
+        return value;
+    };
+    auto family = result["family"].as<string>();
+    auto format = result["format"].as<string>();
+    if (format != "dimacs" && format != "binary") {
+        throw domain_error("Bad format choice.");
+    }
+    if (format == "binary" && !result.count("output")) {
+        throw domain_error("Binary output needs an output file.");
+    }
+    auto matrix_choice = result["matrix"].as<string>();
+    AdjacencyMatrix matrix = AdjacencyMatrix::Auto;
+    if (matrix_choice == "always") {
+        matrix = AdjacencyMatrix::Always;
+    } else if (matrix_choice == "never") {
+        matrix = AdjacencyMatrix::Never;
+    } else if (matrix_choice != "auto") {
+        throw domain_error("Bad matrix choice.");
+    }
+    if (family == "convert") {
+        if (!result.count("input") || format != "binary") {
+            throw domain_error("Convert needs --input and --format=binary.");
+        }
+        // Rebuilt so that the matrix choice applies.
+        auto input = UndirectedGraph::read(result["input"].as<string>());
+        auto graph = UndirectedGraph::from_edges(input.vertices(), [&input](auto add) {
+            for (unsigned i = 0; i < input.vertices(); i++) {
+                for (auto j : input[i]) {
+                    if (i < j) { add(i, j); }
+                }
+            }
+        }, matrix);
+        graph.write_binary(result["output"].as<string>());
+        cerr << "Vertices: " << graph.vertices() << endl;
+        cerr << "Edges: " << graph.edges() << endl;
+        return 0;
+    }
+    Random random(result["seed"].as<uint64_t>());
+    EdgeListGraph graph;
+    if (family == "gnp") {
+        auto n = get("vertices", 0u);
+        graph = generate_gnp(n, get("density", 0.0), random);
+    } else if (family == "gnm") {
+        auto n = get("vertices", 0u);
+        graph = generate_gnm(n, get("edges", uint64_t()), random);
+    } else if (family == "planted" || family == "brock") {
+        auto n = get("vertices", 0u);
+        auto p = get("density", 0.0);
+        auto k = get("clique", 0u);
+        graph = (family == "planted")
+            ? generate_planted(n, p, k, random)
+            : generate_brock(n, p, k, random);
+    } else if (family == "phat") {
+        auto n = get("vertices", 0u);
+        auto a = get("density-min", 0.0);
+        graph = generate_phat(n, a, get("density-max", 0.0), random);
+    } else if (family == "hamming") {
+        auto bits = get("bits", 0u);
+        graph = generate_hamming(bits, get("distance", 0u));
+    } else if (family == "keller") {
+        graph = generate_keller(get("dimension", 0u));
+    } else if (family == "mycielski") {
+        graph = generate_mycielski(get("order", 0u));
+    } else if (family == "insertions" || family == "fullins") {
+        auto k = get("insertions", 0u);
+        graph = generate_insertions(k, get("order", 0u), family == "fullins");
+    } else {
+        throw domain_error("Bad family choice.");
+    }
+    string header = "generate " + family;
+    for (const auto& parameter : parameters) { header += " " + parameter; }
+    header += " --seed=" + to_string(result["seed"].as<uint64_t>());
+    if (format == "binary") {
+        UndirectedGraph(graph.vertices, graph.edges, matrix).write_binary(result["output"].as<string>());
+    } else if (result.count("output")) {
+        ofstream out(result["output"].as<string>());
+        write_dimacs(out, graph, {header});
+        if (!out) { throw runtime_error("Failed to write output file."); }
+    } else {
+        write_dimacs(cout, graph, {header});
+    }
+    cerr << "Vertices: " << graph.vertices << endl;
+    cerr << "Edges: " << graph.edges.size() << endl;
+    return 0;
+}
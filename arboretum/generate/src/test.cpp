@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gsl/gsl_assert>
+
+#include <arbory/struct/graph.hpp>
+
+#include "../include/generators.hpp"
+
+using namespace std;
+
+
+vector<unsigned> degrees(const EdgeListGraph& graph) {
+    vector<unsigned> result(graph.vertices, 0);
+    for (auto [i, j] : graph.edges) {
+        result[i]++;
+        result[j]++;
+    }
+    sort(begin(result), end(result));
+    return result;
+}
+
+
+void report(const string& name, const EdgeListGraph& graph) {
+    cout << name << ": " << graph.vertices << " vertices, "
+         << graph.edges.size() << " edges" << endl;
+}
+
+
+int main() {
+
+    {
+        cout << "======== STRUCTURED =========" << endl;
+        // Sizes of the DIMACS instances of the same name.
+        auto myciel3 = generate_mycielski(3);
+        report("myciel3", myciel3);
+        Expects(myciel3.vertices == 11 && myciel3.edges.size() == 20);
+        auto hamming = generate_hamming(6, 2);
+        report("hamming6-2", hamming);
+        Expects(hamming.vertices == 64 && hamming.edges.size() == 1824);
+        auto insertions = generate_insertions(1, 4, false);
+        report("1-Insertions_4", insertions);
+        Expects(insertions.vertices == 67 && insertions.edges.size() == 232);
+        auto fullins = generate_insertions(2, 3, true);
+        report("2-FullIns_3", fullins);
+        Expects(fullins.vertices == 52 && fullins.edges.size() == 201);
+        // Same degree sequence as the instance file.
+        const auto graph = UndirectedGraph::read_dimacs("../../instances/graphs/2-FullIns_3.col");
+        vector<unsigned> expected;
+        for (unsigned v = 0; v < graph.vertices(); v++) { expected.push_back(graph.degree(v)); }
+        sort(begin(expected), end(expected));
+        Expects(degrees(fullins) == expected);
+        auto keller = generate_keller(2);
+        report("keller(2)", keller);
+        Expects(keller.vertices == 16);
+    }
+
+    {
+        cout << "=========== RANDOM ==========" << endl;
+        Random a(42), b(42);
+        auto gnp = generate_gnp(2000, 0.01, a);
+        report("G(2000, 0.01)", gnp);
+        Expects(gnp.edges == generate_gnp(2000, 0.01, b).edges);
+        auto gnm = generate_gnm(100, 4000, a);
+        report("G(100, 4000)", gnm);
+        Expects(gnm.edges.size() == 4000);
+        auto planted = generate_planted(200, 0.1, 12, a);
+        report("planted(200, 0.1, 12)", planted);
+        for (size_t i = 0; i < planted.planted.size(); i++) {
+            for (size_t j = i + 1; j < planted.planted.size(); j++) {
+                Expects(binary_search(
+                    begin(planted.edges), end(planted.edges),
+                    make_pair(planted.planted[i], planted.planted[j])));
+            }
+        }
+        auto brock = generate_brock(200, 0.7, 20, a);
+        report("brock(200, 0.7, 20)", brock);
+        auto phat = generate_phat(300, 0.25, 0.75, a);
+        report("phat(300, 0.25, 0.75)", phat);
+    }
+
+    {
+        cout << "=========== DIMACS ==========" << endl;
+        stringstream out;
+        write_dimacs(out, generate_mycielski(3), {"myciel3"});
+        cout << out.str().substr(0, out.str().find("\ne ") + 1);
+    }
+
+}
@@ -2,14 +2,84 @@
 #define SRC_MAXIMUMCLIQUE_ALGORITHM_HPP_
 
 #include <optional>
+#include <string>
 #include <vector>
 
+#include <arbory/limits.hpp>
+#include <arbory/monitor.hpp>
+#include <arbory/statistics.hpp>
 #include <arbory/struct/graph.hpp>
 
+#include "heuristic.hpp"
 #include "types.hpp"
 
-std::optional<MaximumCliqueSol> solve_recursive(const UndirectedGraph& graph);
-std::vector<MaximumCliqueSol> solve_backtrack(const UndirectedGraph& graph, unsigned log_frequency);
+// Search state used by the solvers below: candidate vectors
+// (MaximumCliqueState, state.hpp) or bitsets over a relabeled copy of the
+// graph (BitsetCliqueState, bitset_state.hpp; fastest up to some thousands
+// of vertices). Both colour candidates and branch alike, but number
+// vertices differently, so their search trees (and prefixes) differ.
+enum class CliqueRepresentation {
+    Vector,
+    Bitset
+};
+
+// Parse vector or bitset.
+CliqueRepresentation parse_clique_representation(const std::string& name);
+
+// Upper bound on the clique in the candidates: the number of colours, or
+// the number of colours less disjoint sets of colour classes shown by
+// MaxSAT reasoning to be unable to all contribute a vertex (tighter, but
+// costlier per node, so for hard dense instances; bitset state only).
+enum class CliqueBound {
+    Colouring,
+    MaxSat
+};
+
+// Parse colouring or maxsat.
+CliqueBound parse_clique_bound(const std::string& name);
+
+// The heuristic (heuristic.hpp) runs before the exact search, which starts
+// from its clique as incumbent; it is off unless given steps.
+struct CliqueOptions {
+    CliqueRepresentation representation = CliqueRepresentation::Vector;
+    CliqueBound bound = CliqueBound::Colouring;
+    HeuristicLimits heuristic;
+};
+
+std::optional<MaximumCliqueSol> solve_recursive(
+    const UndirectedGraph& graph,
+    const CliqueOptions& options = CliqueOptions());
+std::optional<MaximumCliqueSol> solve_recursive_parallel(
+    const UndirectedGraph& graph, unsigned threads,
+    const CliqueOptions& options = CliqueOptions());
+// Returns up to pool_size of the best solutions found, worst to best.
+// With profile set, hardware counters are reported for each search phase.
+// With a trace file, the search's transitions are recorded for replay.
+std::vector<MaximumCliqueSol> solve_backtrack(
+    const UndirectedGraph& graph, const LogOptions& log,
+    const SearchLimits& limits = SearchLimits(), size_t pool_size = 1,
+    bool profile = false, const std::string& trace = "",
+    const CliqueOptions& options = CliqueOptions());
+// Time the transitions of a recorded search on a fresh root state.
+void replay_search_trace(
+    const UndirectedGraph& graph, const LogOptions& log, const std::string& trace,
+    const CliqueOptions& options = CliqueOptions());
+// Prefixes of n disjoint subtrees covering the search tree.
+std::vector<std::string> split_subproblems(
+    const UndirectedGraph& graph, unsigned n,
+    const CliqueOptions& options = CliqueOptions());
+// Search only the subtree at the prefix, reporting only cliques larger than
+// primal_bound (if given).
+std::vector<MaximumCliqueSol> solve_subproblem(
+    const UndirectedGraph& graph, const LogOptions& log, const SearchLimits& limits,
+    const std::string& prefix, std::optional<unsigned> primal_bound,
+    const CliqueOptions& options = CliqueOptions());
+std::vector<MaximumCliqueSol> solve_parallel(
+    const UndirectedGraph& graph, unsigned threads,
+    const CliqueOptions& options = CliqueOptions());
+std::vector<MaximumCliqueSol> solve_bestfirst(
+    const UndirectedGraph& graph, size_t max_open,
+    const CliqueOptions& options = CliqueOptions());
 
 // Partition vertices into (clique, other).
 // Return the number of elements in the clique.
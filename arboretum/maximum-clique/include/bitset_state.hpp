@@ -0,0 +1,342 @@
+#ifndef SRC_MAXIMUMCLIQUE_BITSET_STATE_HPP_
+#define SRC_MAXIMUMCLIQUE_BITSET_STATE_HPP_
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <gsl/gsl_assert>
+#include <arbory/struct/bitset.hpp>
+#include <arbory/struct/graph.hpp>
+#include <arbory/struct/relabel.hpp>
+
+#include "types.hpp"
+
+
+// Result of an include branch: how many vertices joined the clique (the
+// branch vertex and any implied by it).
+class BitsetIncludeResult {
+    unsigned clique_move;
+public:
+    explicit BitsetIncludeResult(unsigned c) : clique_move(c) {}
+    unsigned get_clique_move() const { return clique_move; }
+};
+
+// The exclude branch only drops the last coloured candidate.
+struct BitsetExcludeResult {};
+
+
+//
+// Bit-parallel maximum clique state (San Segundo et al.'s BBMC), an
+// alternative to MaximumCliqueState with the same branching scheme:
+// candidates are greedily coloured, and the candidate of highest colour is
+// included in one branch and excluded in the other.
+//
+// The graph is relabeled in degeneracy order (densest core first) with a
+// bit matrix, so the candidate set of each include level is a bitset and
+// the include branch is a word-wise AND of the parent's set with the branch
+// vertex's adjacency row. Colouring is bit-parallel too: each class is
+// built by taking the first remaining candidate and masking out its
+// neighbours a word at a time, which visits low-numbered (dense core)
+// vertices first.
+//
+// Each include level holds its candidate bitset and its candidates in
+// colour order (followed by those it has excluded), both in flat stacks, so
+// branching never allocates once the stacks reach the search depth:
+//
+//  level 0:  sets[0 .. W)        order/color[levels[0].first .. levels[0].last)
+//  level 1:  sets[W .. 2W)       order/color[levels[1].first .. levels[1].last)
+//  ...
+//
+// Excluding the last candidate of the top level removes it from the set
+// and the coloured order, leaving a valid colouring of the rest.
+//
+// Optionally the colours are tightened by MaxSAT reasoning (Li and Quan's
+// IncMaxCLQ): each colour class is a soft clause "one of these vertices is
+// in the clique", and a set of classes which can't all be hit by one clique
+// lowers the bound of every candidate coloured after it by one. A class is
+// shown to be in such a set if including any of its vertices empties an
+// earlier unused class by unit propagation (failed literals). Only classes
+// above the size of the largest clique this state has reached are tested,
+// and the tightened colours are kept with the level, so they are reused by
+// every exclude branch below it.
+//
+class BitsetCliqueState {
+    // Relabeled graph, shared by clones.
+    std::shared_ptr<const RelabeledGraph> relabeled;
+    const UndirectedGraph* graph;
+    size_t words;
+    struct Level {
+        unsigned first;
+        unsigned last;
+    };
+    std::vector<Level> levels;
+    std::vector<uint64_t> sets;
+    std::vector<unsigned> order;
+    std::vector<unsigned> color;
+    std::vector<unsigned> clique;
+    // Scratch sets for colouring.
+    std::vector<uint64_t> uncolored;
+    std::vector<uint64_t> available;
+    // MaxSAT bound: largest clique reached so far, and scratch for the
+    // classes of the top level (first positions, bitsets, whether used in an
+    // inconsistent set, and what remains of them during propagation).
+    bool maxsat;
+    unsigned target;
+    std::vector<unsigned> class_first;
+    std::vector<uint64_t> class_sets;
+    std::vector<char> used;
+    std::vector<uint64_t> alive;
+    std::vector<unsigned> pending;
+    std::vector<unsigned> involved;
+    std::vector<unsigned> reasons;
+
+    BitsetCliqueState(const BitsetCliqueState&) = default;
+
+    uint64_t* top_set() { return sets.data() + (levels.size() - 1) * words; }
+
+    // Colour the top level's candidate set into its coloured order.
+    // Returns the number of candidates.
+    unsigned color_top() {
+        const uint64_t* set = top_set();
+        std::copy(set, set + words, std::begin(uncolored));
+        auto& level = levels.back();
+        order.resize(level.first);
+        color.resize(level.first);
+        unsigned k = 0;
+        size_t first_word = 0;
+        for (;;) {
+            while (first_word < words && uncolored[first_word] == 0) { ++first_word; }
+            if (first_word == words) { break; }
+            ++k;
+            std::copy(std::begin(uncolored) + first_word, std::end(uncolored),
+                      std::begin(available) + first_word);
+            for (size_t w = first_word; w < words; w++) {
+                while (available[w] != 0) {
+                    unsigned v = w * 64 + __builtin_ctzll(available[w]);
+                    reset_bit(uncolored.data(), v);
+                    order.push_back(v);
+                    color.push_back(k);
+                    // Later words of the row; this word's lower bits are done.
+                    const uint64_t* row = graph->row(v);
+                    available[w] &= ~row[w] & (available[w] - 1);
+                    for (size_t x = w + 1; x < words; x++) { available[x] &= ~row[x]; }
+                }
+            }
+        }
+        level.last = order.size();
+        return level.last - level.first;
+    }
+
+    // Number of bits of a set, counting no further than two. Sets *bit to
+    // the first bit found.
+    unsigned count_to_two(const uint64_t* set, unsigned* bit) const {
+        unsigned count = 0;
+        for (size_t w = 0; w < words; w++) {
+            if (set[w] == 0) { continue; }
+            if (count > 0 || (set[w] & (set[w] - 1)) != 0) { return 2; }
+            *bit = w * 64 + __builtin_ctzll(set[w]);
+            count = 1;
+        }
+        return count;
+    }
+
+    // Whether including v empties one of the unused classes before class c
+    // by unit propagation. If so, the classes involved are left in involved.
+    bool fails(unsigned v, unsigned c) {
+        pending.clear();
+        involved.clear();
+        const uint64_t* row = graph->row(v);
+        for (unsigned j = 1; j < c; j++) {
+            if (used[j]) { continue; }
+            and_words(&alive[(j - 1) * words], &class_sets[(j - 1) * words], row, words);
+            pending.push_back(j);
+        }
+        bool progress = true;
+        while (progress) {
+            progress = false;
+            for (size_t k = 0; k < pending.size(); k++) {
+                unsigned j = pending[k];
+                unsigned u = 0;
+                auto count = count_to_two(&alive[(j - 1) * words], &u);
+                if (count == 2) { continue; }
+                involved.push_back(j);
+                if (count == 0) { return true; }
+                // Class j is a unit: u is in the clique.
+                pending.erase(std::begin(pending) + k);
+                const uint64_t* urow = graph->row(u);
+                for (auto i : pending) {
+                    and_words(&alive[(i - 1) * words], &alive[(i - 1) * words], urow, words);
+                }
+                progress = true;
+                break;
+            }
+        }
+        return false;
+    }
+
+    // Lower the colours of the top level's classes above target - |C| by
+    // the number of disjoint inconsistent sets of classes found up to them.
+    void tighten_colors() {
+        const auto& level = levels.back();
+        unsigned k = color[level.last - 1];
+        unsigned lowest = target > clique.size() ? target - clique.size() : 0;
+        if (k <= lowest) { return; }
+        class_first.assign(k + 2, level.last);
+        class_sets.assign(k * words, 0);
+        for (unsigned i = level.last; i-- > level.first; ) {
+            class_first[color[i]] = i;
+            set_bit(&class_sets[(color[i] - 1) * words], order[i]);
+        }
+        used.assign(k + 1, 0);
+        alive.resize(k * words);
+        unsigned removed = 0;
+        for (unsigned c = lowest + 1; c <= k; c++) {
+            bool inconsistent = true;
+            reasons.clear();
+            for (unsigned i = class_first[c]; i < class_first[c + 1] && inconsistent; i++) {
+                inconsistent = fails(order[i], c);
+                reasons.insert(std::end(reasons), std::begin(involved), std::end(involved));
+            }
+            if (inconsistent) {
+                used[c] = 1;
+                for (auto j : reasons) { used[j] = 1; }
+                ++removed;
+            }
+            for (unsigned i = class_first[c]; i < class_first[c + 1]; i++) {
+                color[i] = c - removed;
+            }
+        }
+    }
+
+    // Colour the top level, including every candidate by implication if
+    // they all have colours of their own (they then form a clique).
+    // Returns the number of vertices added to the clique.
+    unsigned color_and_imply() {
+        auto count = color_top();
+        if (count == 0 || color.back() != count) {
+            if (maxsat && count > 0) { tighten_colors(); }
+            return 0;
+        }
+        auto& level = levels.back();
+        for (unsigned i = level.first; i < level.last; i++) { clique.push_back(order[i]); }
+        std::fill(top_set(), top_set() + words, 0);
+        level.last = level.first;
+        return count;
+    }
+
+    // Leaves are cliques, so they raise the threshold of the MaxSAT bound.
+    void reached() {
+        if (is_leaf() && clique.size() > target) { target = clique.size(); }
+    }
+
+public:
+    // Search for cliques in the given vertices of the graph. The relabeled
+    // copy has a bit matrix whatever its size, so this state suits graphs of
+    // up to some thousands of vertices (the solvers refuse graphs whose
+    // matrix would exceed UndirectedGraph::matrix_max_bytes). The MaxSAT
+    // bound starts from known_clique, the size of a clique already found.
+    BitsetCliqueState(const UndirectedGraph& g, const std::vector<unsigned>& vertices,
+                      bool maxsat_bound = false, unsigned known_clique = 0) :
+            relabeled(std::make_shared<const RelabeledGraph>(
+                g, VertexOrder::Degeneracy, AdjacencyMatrix::Always)),
+            graph(&relabeled->graph()), words(bitset_words(g.vertices())),
+            levels{Level{0, 0}}, sets(words, 0), order(), color(), clique(),
+            uncolored(words), available(words), maxsat(maxsat_bound), target(known_clique),
+            class_first(), class_sets(), used(), alive(), pending(), involved(), reasons() {
+        std::vector<unsigned> renumbered(g.vertices());
+        for (unsigned v = 0; v < g.vertices(); v++) {
+            renumbered[relabeled->original(v)] = v;
+        }
+        for (auto v : vertices) { set_bit(sets.data(), renumbered[v]); }
+    }
+    BitsetCliqueState(BitsetCliqueState&&) = default;
+
+    // Copy of the state owning its own stacks, for use by another thread.
+    BitsetCliqueState clone() const {
+        return *this;
+    }
+
+    // Colours the root candidates (as MaximumCliqueState::sort_and_imply).
+    void sort_and_imply() {
+        Expects(levels.size() == 1);
+        color_and_imply();
+        reached();
+    }
+
+    std::pair<unsigned, BitsetIncludeResult> branch() {
+        unsigned branch_vertex = order[levels.back().last - 1];
+        return std::make_pair(branch_vertex, branch(branch_vertex));
+    }
+
+    // Include the candidate of highest colour: its level's set and its
+    // adjacency row are ANDed into a new level, which is coloured.
+    BitsetIncludeResult branch(const unsigned& branch_vertex) {
+        Expects(order[levels.back().last - 1] == branch_vertex);
+        // After the parent's list, including its excluded candidates.
+        const unsigned first = order.size();
+        levels.push_back(Level{first, first});
+        sets.resize(levels.size() * words);
+        uint64_t* set = top_set();
+        and_words(set, set - words, graph->row(branch_vertex), words);
+        clique.push_back(branch_vertex);
+        BitsetIncludeResult result(1 + color_and_imply());
+        reached();
+        return result;
+    }
+
+    void backtrack(const unsigned& vertex, const BitsetIncludeResult& result) {
+        clique.resize(clique.size() - result.get_clique_move());
+        order.resize(levels.back().first);
+        color.resize(levels.back().first);
+        levels.pop_back();
+        Ensures(order[levels.back().last - 1] == vertex);
+    }
+
+    // Exclude the candidate of highest colour.
+    BitsetExcludeResult branch_alternate(const unsigned& vertex) {
+        Expects(order[levels.back().last - 1] == vertex);
+        reset_bit(top_set(), vertex);
+        levels.back().last--;
+        reached();
+        return BitsetExcludeResult();
+    }
+
+    void backtrack(const unsigned& vertex, const BitsetExcludeResult&) {
+        Expects(order[levels.back().last] == vertex);
+        set_bit(top_set(), vertex);
+        levels.back().last++;
+    }
+
+    bool is_leaf() const {
+        return levels.back().first == levels.back().last;
+    }
+
+    constexpr bool is_feasible() const { return true; }
+
+    // The clique plus the highest candidate colour (as tightened).
+    unsigned get_upper_bound() const {
+        return is_leaf() ? clique.size() : clique.size() + color[levels.back().last - 1];
+    }
+
+    // If at a leaf state, return the solution (in the graph's numbering).
+    MaximumCliqueSol get_solution() const {
+        auto vertices = relabeled->original(clique);
+        return MaximumCliqueSol(std::begin(vertices), std::end(vertices));
+    }
+
+    void print_state() const {
+        std::cout << "Clique:";
+        for (auto v : clique) { std::cout << " " << relabeled->original(v); }
+        std::cout << "  Candidates:";
+        for (unsigned i = levels.back().first; i < levels.back().last; i++) {
+            std::cout << " " << relabeled->original(order[i]) << "(" << color[i] << ")";
+        }
+        std::cout << std::endl;
+    }
+
+};
+
+#endif  // SRC_MAXIMUMCLIQUE_BITSET_STATE_HPP_
@@ -0,0 +1,27 @@
+#ifndef SRC_MAXIMUMCLIQUE_HEURISTIC_HPP_
+#define SRC_MAXIMUMCLIQUE_HEURISTIC_HPP_
+
+#include <limits>
+#include <vector>
+
+#include <arbory/struct/graph.hpp>
+
+
+// Budget of the heuristic: local search steps and seconds. No steps turns
+// it off.
+struct HeuristicLimits {
+    unsigned long steps = 0;
+    double time = std::numeric_limits<double>::infinity();
+};
+
+
+// A large clique found quickly, to seed the exact search's primal bound.
+// Greedy construction from the highest degree vertices is followed by a
+// plateau search after Pullan and Hoos' DLS-MC: add a vertex adjacent to the
+// whole clique if there is one, otherwise swap in a vertex adjacent to all
+// but one member, and after a while on a plateau restart from a random
+// vertex and the members adjacent to it. Deterministic unless stopped by
+// the time limit. Empty if the limits allow no steps.
+std::vector<unsigned> heuristic_clique(const UndirectedGraph& graph, const HeuristicLimits& limits);
+
+#endif  // SRC_MAXIMUMCLIQUE_HEURISTIC_HPP_
@@ -3,95 +3,275 @@
 
 #include <algorithm>
 #include <iostream>
+#include <limits>
 #include <utility>
 #include <vector>
 
 #include <gsl/gsl_assert>
+#include <arbory/struct/bitset.hpp>
 #include <arbory/struct/graph.hpp>
+#include <arbory/trail.hpp>
 
 #include "types.hpp"
 
 
-// Stores how far the neighbours_end iterator was moved so the include branch
-// can be backtracked.
+// Stores how far the clique_end and neighbours_end iterators were moved, and
+// where the include branch's changes were recorded on the trail, so it can be
+// backtracked.
 class IncludeResult {
     unsigned clique_move;
     unsigned neighbours_move;
+    UndoTrail<unsigned>::Mark mark;
 public:
-    explicit IncludeResult(unsigned c, unsigned n) :
-        clique_move(c), neighbours_move(n) {}
+    explicit IncludeResult(unsigned c, unsigned n, UndoTrail<unsigned>::Mark m) :
+        clique_move(c), neighbours_move(n), mark(m) {}
     unsigned get_clique_move() const { return clique_move; }
     unsigned get_neighbours_move() const { return neighbours_move; }
+    UndoTrail<unsigned>::Mark get_mark() const { return mark; }
 };
 
+// The exclude branch only moves neighbours_end back by one.
+struct ExcludeResult {};
+
 
 //
 // Maximum clique state representation. e.g.
 //
-//  state = [  1  4  5  8  2  6  7  3  0  9  ]
+//  state = [  1  4  5  2  8  6  7  3  0  9  ]
+//  color =             1  1  2  3
 //             B        C           N        E
 //
 // The :state array contains the set of vertices over which we are searching
-// for a maximum clique. Two pointers, clique_end (C) and neighbours_end (N)
-// are kept.
+// for a maximum clique and is owned by the state so it can be cloned. Two
+// positions, clique_end (C) and neighbours_end (N) are kept.
 // All vertices to the left of C are currently in the clique. In the above
 // example it has been verified that {1, 4, 5} in the above example form a
 // clique in the target graph.
 // Vertices in the range [C, N) are candidates to be added to the clique. In the
-// above example, {8, 2, 6, 7} are all adjacent to all vertices in {1, 4, 5}.
+// above example, {2, 8, 6, 7} are all adjacent to all vertices in {1, 4, 5}.
 // but it has not been checked whether they are adjacent to one another).
 // Vertices at and to the right of N cannot be added to the current clique at
 // this branch since they have been determined in previous steps not to be
 // neighbours of some vertex in {1, 4, 5}.
 //
-// To transition to an 'include' state, a new vertex from the range C->N is
-// selected by advancing the pointer C. The new range C->N is partitioned into
-// neighbours and non-neighbours of the branch vertex.
+// Candidates are greedily coloured (Tomita & Seki's MCQ): no two vertices of
+// a colour class are adjacent, so a clique holds at most one vertex of each
+// class and the clique size plus the number of colours bounds any clique
+// below this state. Candidates are kept in order of colour, as in :color.
+// They are coloured in order of their degree among the candidates, counted
+// afresh for each include branch, and any candidate adjacent to all others
+// is in every maximal clique below the state, so it joins the clique
+// without branching.
+//
+// To transition to an 'include' state, the vertex of highest colour (at N - 1,
+// here 7) is moved to C and the pointer C advanced. The remaining candidates
+// are partitioned into neighbours and non-neighbours of the branch vertex,
+// and the neighbours are coloured afresh.
 //
-//  state = [  1  4  5  8  7  6  2  3  0  9  ]
+//  state = [  1  4  5  7  6  2  8  3  0  9  ]
+//  color =                1  2
 //             B           C     N           E
 //
-// In thie example, vertex 8 is added to the clique (this is valid because it
-// was already vertified as a neighbour of all vertices in {1, 4, 5}). The
-// partion and update divides the set of candidates into {7, 6} which are
-// neighbours of 8 and {2} which are not. Thus {7, 6} are continuing candidates
-// for inclusion but all vertices to the right of N cannot be added to the
-// clique in this branch.
+// In this example, vertex 7 is added to the clique (this is valid because it
+// was already verified as a neighbour of all vertices in {1, 4, 5}). The
+// partition divides the set of candidates into {6, 2} which are neighbours
+// of 7 and {8} which are not. Thus {6, 2} are continuing candidates for
+// inclusion but all vertices to the right of N cannot be added to the clique
+// in this branch. The swaps made and the colours overwritten are recorded on
+// a trail and reverted on backtracking, at a cost proportional to the new
+// candidates (or the branch vertex's degree) rather than the old ones.
 //
-// The opposing 'exclude' branch swaps the vertex 8 into the set [N, E) to ensure
-// it is not considered in any further search. Only {2, 6, 7} are considered
-// below this state.
+// The opposing 'exclude' branch moves N back past the vertex 7 to ensure it
+// is not considered in any further search. The other candidates keep their
+// order and colours, which remain a valid colouring, so only the bound
+// changes: here to 3 + 2. Branching in decreasing colour order this way
+// prunes the remaining candidates as soon as the clique plus the colour of
+// the last candidate cannot beat the incumbent.
 //
-//  state = [  1  4  5  7  2  6  8  3  0  9  ]
+//  state = [  1  4  5  2  8  6  7  3  0  9  ]
+//  color =             1  1  2
 //             B        C        N           E
 //
 class MaximumCliqueState {
-    using Iter = std::vector<unsigned>::iterator;
-
     const UndirectedGraph & graph;
-    Iter state_begin;
-    Iter clique_end;
-    Iter neighbours_end;
-    Iter state_end;
+    std::vector<unsigned> state;
+    // Colour class (from 1) of the vertex at each candidate position.
+    std::vector<unsigned> color;
+    // Position of each vertex of the graph in :state (absent: none).
+    std::vector<unsigned> position;
+    unsigned clique_end;
+    unsigned neighbours_end;
+    // Swaps made by include branches, and the candidates and colours they
+    // overwrote.
+    UndoTrail<unsigned> trail;
+    // Degree of each candidate among the candidates (by vertex), and the
+    // candidates as a set for counting them with a bit matrix. Unless they
+    // were counted that way, the neighbours found are kept for colouring:
+    // those of v are local[local_first[v] .. local_first[v] + support[v]).
+    std::vector<unsigned> support;
+    VertexSet members;
+    std::vector<unsigned> local_first;
+    std::vector<unsigned> local;
+    bool local_lists;
+    // Scratch space for colouring: the members of each class, and stamps
+    // marking the vertices coloured in a pass (by vertex) and the classes
+    // seen when placing a vertex (by class).
+    std::vector<std::vector<unsigned>> classes;
+    std::vector<unsigned> colored;
+    std::vector<unsigned> seen;
+    unsigned pass_stamp;
+    unsigned probe_stamp;
+
+    static constexpr unsigned absent = std::numeric_limits<unsigned>::max();
+
+    MaximumCliqueState(const MaximumCliqueState&) = default;
+
+    bool is_candidate(unsigned v) const {
+        return position[v] >= clique_end && position[v] < neighbours_end;
+    }
+
+    void swap_positions(unsigned i, unsigned j) {
+        std::swap(state[i], state[j]);
+        std::swap(color[i], color[j]);
+        position[state[i]] = i;
+        position[state[j]] = j;
+    }
+
+    // Fresh stamps, clearing the stamped arrays when the counters wrap.
+    static unsigned next_stamp(unsigned* stamp, std::vector<unsigned>* stamped) {
+        if (++*stamp == 0) {
+            std::fill(std::begin(*stamped), std::end(*stamped), 0);
+            *stamp = 1;
+        }
+        return *stamp;
+    }
+
+    // Lowest class (from 0) of the first count classes with no neighbour of
+    // v, scanning whichever is shorter: the members coloured so far, or the
+    // neighbours of v (which must then be stamped as coloured).
+    unsigned first_free_class(unsigned v, unsigned count, unsigned members, unsigned pass) {
+        if (local_lists || graph.degree(v) < members) {
+            if (seen.size() < count) { seen.resize(count, 0); }
+            unsigned probe = next_stamp(&probe_stamp, &seen);
+            auto neighbours = local_lists
+                ? NeighbourRange(&local[local_first[v]], &local[local_first[v]] + support[v])
+                : graph[v];
+            for (auto u : neighbours) {
+                if (colored[u] == pass) { seen[color[position[u]] - 1] = probe; }
+            }
+            unsigned k = 0;
+            while (k < count && seen[k] == probe) { ++k; }
+            return k;
+        }
+        unsigned k = 0;
+        while (k < count && std::any_of(
+                std::begin(classes[k]), std::end(classes[k]),
+                [this, v](unsigned u) { return graph.adjacent(u, v); })) {
+            ++k;
+        }
+        return k;
+    }
+
+    // Count the neighbours of each candidate among the candidates, as bits
+    // of the matrix for candidate sets of more vertices than it has words
+    // per row, otherwise over adjacency lists (random bit tests in a large
+    // matrix miss the cache). Those found are kept for colouring.
+    void count_support() {
+        const unsigned count = neighbours_end - clique_end;
+        local_lists = false;
+        if (count == graph.vertices()) {
+            // Every vertex is a candidate (at the root).
+            for (unsigned i = clique_end; i < neighbours_end; i++) {
+                support[state[i]] = graph.degree(state[i]);
+            }
+            return;
+        }
+        if (graph.has_matrix() && count >= members.words()) {
+            for (unsigned i = clique_end; i < neighbours_end; i++) { members.set(state[i]); }
+            for (unsigned i = clique_end; i < neighbours_end; i++) {
+                support[state[i]] = graph.count_neighbours(state[i], members);
+            }
+            for (unsigned i = clique_end; i < neighbours_end; i++) { members.reset(state[i]); }
+            return;
+        }
+        local.clear();
+        for (unsigned i = clique_end; i < neighbours_end; i++) {
+            unsigned v = state[i];
+            local_first[v] = local.size();
+            for (auto u : graph[v]) {
+                if (is_candidate(u)) { local.push_back(u); }
+            }
+            support[v] = local.size() - local_first[v];
+        }
+        local_lists = true;
+    }
+
+    // Greedy sequential colouring of the candidates, taken in order of
+    // non-increasing degree among the candidates (ties on vertex index, so
+    // the colouring depends only on the candidate set), rewritten into
+    // [C, N) class by class.
+    void color_candidates() {
+        auto first = std::begin(state) + clique_end;
+        auto last = std::begin(state) + neighbours_end;
+        std::sort(first, last, [this](unsigned u, unsigned v) {
+            return std::make_pair(support[v], u) < std::make_pair(support[u], v);
+        });
+        for (unsigned i = clique_end; i < neighbours_end; i++) { position[state[i]] = i; }
+        unsigned pass = next_stamp(&pass_stamp, &colored);
+        unsigned colors = 0;
+        for (unsigned i = clique_end; i < neighbours_end; i++) {
+            unsigned v = state[i];
+            unsigned k = first_free_class(v, colors, i - clique_end, pass);
+            if (k == colors) {
+                if (classes.size() == colors) { classes.emplace_back(); }
+                classes[colors++].clear();
+            }
+            classes[k].push_back(v);
+            // Read back through position by first_free_class.
+            color[i] = k + 1;
+            colored[v] = pass;
+        }
+        unsigned i = clique_end;
+        for (unsigned k = 0; k < colors; k++) {
+            for (auto v : classes[k]) {
+                state[i] = v;
+                color[i] = k + 1;
+                position[v] = i;
+                ++i;
+            }
+        }
+    }
 
 public:
-    MaximumCliqueState(const UndirectedGraph& g, Iter b, Iter e) :
-        graph(g), state_begin(b), clique_end(b),
-        neighbours_end(e), state_end(e) {}
+    // The bound is valid once sort_and_imply() has been called.
+    MaximumCliqueState(const UndirectedGraph& g, std::vector<unsigned> vertices) :
+            graph(g), state(std::move(vertices)), color(state.size(), 0),
+            position(g.vertices(), absent), clique_end(0), neighbours_end(state.size()),
+            trail(), support(g.vertices(), 0),
+            members(g.has_matrix() ? g.vertices() : 0),
+            local_first(g.vertices(), 0), local(), local_lists(false), classes(),
+            colored(g.vertices(), 0), seen(), pass_stamp(0), probe_stamp(0) {
+        for (unsigned i = 0; i < state.size(); i++) { position[state[i]] = i; }
+    }
+    MaximumCliqueState(MaximumCliqueState&&) = default;
+
+    // Copy of the state owning its own vertex array, for use by another
+    // thread.
+    MaximumCliqueState clone() const {
+        return *this;
+    }
 
-    // Brings the next vertex to be branched on to the first candidate position.
-    // The branch vertex is included by implication if possible.
+    // Includes the candidates adjacent to all others by implication, then
+    // colours the rest, leaving the next vertex to be branched on at the
+    // last candidate position.
     void sort_and_imply() {
-        while (clique_end != neighbours_end) {
-            std::partial_sort(clique_end, clique_end + 1, neighbours_end, [this](unsigned u, unsigned v) {
-                return graph.degree(u) < graph.degree(v);
-            });
-            if (std::any_of(
-                clique_end + 1, neighbours_end,
-                [this](unsigned v) { return !graph.adjacent(*clique_end, v); }))
-                { break; }
-            ++clique_end;
+        count_support();
+        const unsigned count = neighbours_end - clique_end;
+        for (unsigned i = clique_end; i < neighbours_end; i++) {
+            if (support[state[i]] + 1 == count) { swap_positions(clique_end++, i); }
         }
+        // Including them lowers every other count by the same amount.
+        color_candidates();
     }
 
     // Alter the state to check the include(v) branch. The returned result object
@@ -99,44 +279,85 @@ public:
     // (i.e. how many vertices were rejected as a result of including the branch
     // vertex in the clique) to allow backtracking.
     std::pair<unsigned, IncludeResult> branch() {
+        unsigned branch_vertex = state[neighbours_end - 1];
+        return std::make_pair(branch_vertex, branch(branch_vertex));
+    }
+
+    // Re-enter the include branch for a previously made decision.
+    IncludeResult branch(const unsigned& branch_vertex) {
+        Expects(state[neighbours_end - 1] == branch_vertex);
         auto prev_clique_end = clique_end;
         auto prev_neighbours_end = neighbours_end;
-        // Add the branch vertex to the clique and update candidate set.
+        auto mark = trail.mark();
+        // Add the branch vertex to the clique, then swap its neighbours to the
+        // front of the candidates, found from whichever is shorter: its
+        // adjacency list or the candidates. Each swap is recorded by the
+        // position it took a vertex from.
+        trail.push(neighbours_end - 1);
+        swap_positions(clique_end, neighbours_end - 1);
         ++clique_end;
-        neighbours_end = std::partition(clique_end, neighbours_end, [this, prev_clique_end](unsigned v) {
-            return graph.adjacent(*prev_clique_end, v);
-        });
-        // Expects(neighbours_end != prev_neighbours_end);
-        // Look for implied inclusions, record pointer movements for backtracking.
+        unsigned front = clique_end;
+        if (graph.degree(branch_vertex) < neighbours_end - clique_end) {
+            for (auto v : graph[branch_vertex]) {
+                if (is_candidate(v) && position[v] >= front) {
+                    trail.push(position[v]);
+                    swap_positions(front++, position[v]);
+                }
+            }
+        } else {
+            for (unsigned i = clique_end; i < neighbours_end; i++) {
+                if (graph.adjacent(branch_vertex, state[i])) {
+                    trail.push(i);
+                    swap_positions(front++, i);
+                }
+            }
+        }
+        neighbours_end = front;
+        // Save the new candidates and their colours, which are overwritten.
+        for (unsigned i = clique_end; i < neighbours_end; i++) { trail.push(state[i]); }
+        for (unsigned i = clique_end; i < neighbours_end; i++) { trail.push(color[i]); }
+        // Colour the new candidates, recording pointer movements for backtracking.
         sort_and_imply();
-        return std::make_pair(*prev_clique_end, IncludeResult(
+        return IncludeResult(
             clique_end - prev_clique_end,
-            prev_neighbours_end - neighbours_end));
+            prev_neighbours_end - neighbours_end, mark);
     }
 
     // Revert a call to branch(), transitioning to the parent state.
     void backtrack(const unsigned& vertex, const IncludeResult& result) {
         clique_end -= result.get_clique_move();
+        const unsigned candidates_end = neighbours_end;
         neighbours_end += result.get_neighbours_move();
-        Ensures(*clique_end == vertex);
+        // Trail: the swap sources, then the candidates and their colours.
+        const auto saved = trail.since(result.get_mark());
+        const unsigned count = candidates_end - clique_end - 1;
+        Expects(saved.size() == 1 + 3 * count);
+        const unsigned* swaps = saved.begin();
+        const unsigned* vertices = swaps + 1 + count;
+        const unsigned* colors = vertices + count;
+        for (unsigned k = 0; k < count; k++) {
+            unsigned i = clique_end + 1 + k;
+            state[i] = vertices[k];
+            color[i] = colors[k];
+            position[state[i]] = i;
+        }
+        for (unsigned k = count + 1; k-- > 0;) {
+            swap_positions(clique_end + k, swaps[k]);
+        }
+        trail.pop_to(result.get_mark());
+        Ensures(state[neighbours_end - 1] == vertex);
     }
 
     // Alter the state to check the exclude(v) branch.
-    unsigned branch_alternate(const unsigned& vertex) {
-        Expects(*clique_end == vertex);
-        auto prev_clique_end = clique_end;
-        // Move the branch vertex into the excluded set.
+    ExcludeResult branch_alternate(const unsigned& vertex) {
+        Expects(state[neighbours_end - 1] == vertex);
         --neighbours_end;
-        std::swap(*clique_end, *neighbours_end);
-        // Look for implied inclusions, record pointer movement.
-        sort_and_imply();
-        return clique_end - prev_clique_end;
+        return ExcludeResult();
     }
 
     // Reverts a call to branch_alternate(), transitioning to the parent state.
-    void backtrack(const unsigned& vertex, const unsigned& clique_moved) {
-        Expects(*neighbours_end == vertex);
-        clique_end -= clique_moved;
+    void backtrack(const unsigned& vertex, const ExcludeResult&) {
+        Expects(state[neighbours_end] == vertex);
         ++neighbours_end;
     }
 
@@ -149,21 +370,21 @@ public:
     constexpr bool is_feasible() const { return true; }
 
     // Returns the best-case objective function which could potentially be
-    // found below this node.
+    // found below this node: the clique plus the highest candidate colour.
     unsigned get_upper_bound() const {
-        return neighbours_end - state_begin;
+        return is_leaf() ? clique_end : clique_end + color[neighbours_end - 1];
     }
 
     // If at a leaf state, return the solution.
     MaximumCliqueSol get_solution() const {
-        return MaximumCliqueSol(state_begin, clique_end);
+        return MaximumCliqueSol(std::begin(state), std::begin(state) + clique_end);
     }
 
     void print_state() const {
-        std::for_each(state_begin, state_end,
+        std::for_each(std::begin(state), std::end(state),
                       [](int n){ std::cout << n << " "; });
         std::cout << std::endl;
-        for (unsigned i = 0; i < clique_end - state_begin; i++) {
+        for (unsigned i = 0; i < clique_end; i++) {
             std::cout << "  ";
         }
         std::cout << "C";
@@ -1,55 +1,215 @@
 
-#include <chrono>
+#include <stdexcept>
+#include <type_traits>
 #include <vector>
 
 #include <arbory/backtracking.hpp>
+#include <arbory/bestfirst.hpp>
+#include <arbory/decomposition.hpp>
+#include <arbory/parallel.hpp>
+#include <arbory/profile.hpp>
 #include <arbory/recursion.hpp>
+#include <arbory/replay.hpp>
 #include <arbory/sense.hpp>
+#include <arbory/sinks.hpp>
 #include <gsl/gsl_assert>
 
 #include "../include/algorithm.hpp"
+#include "../include/bitset_state.hpp"
 #include "../include/state.hpp"
 
 using namespace std;
 
 
-MaximumCliqueState root_state(const UndirectedGraph& graph, vector<unsigned>* initial_order) {
-    Expects(initial_order->empty());
-    initial_order->reserve(graph.vertices());
+// Coloured root state of either representation.
+template <typename State, typename... Args>
+State root_state(const UndirectedGraph& graph, Args... args) {
+    vector<unsigned> initial_order;
+    initial_order.reserve(graph.vertices());
     for (unsigned i = 0; i < graph.vertices(); i++) {
-        initial_order->push_back(i);
+        initial_order.push_back(i);
     }
-    return MaximumCliqueState(graph, begin(*initial_order), end(*initial_order));
+    State state(graph, move(initial_order), args...);
+    state.sort_and_imply();
+    return state;
 }
 
 
-optional<MaximumCliqueSol> solve_recursive(const UndirectedGraph& graph) {
-    vector<unsigned> initial_order;
-    auto state = root_state(graph, &initial_order);
-    state.sort_and_imply();
-    auto start = chrono::high_resolution_clock::now();
-    auto solution = solve_recursive<MaximumCliqueState, Sense::Maximize>(&state);
-    double runtime = std::chrono::duration<double, std::milli>
-        (chrono::high_resolution_clock::now() - start)
-        .count() / 1000;
-    cout << "Time: " << runtime << " seconds" << endl;
-    return solution;
+// Call f with a pointer to a root state of the chosen representation. The
+// MaxSAT bound starts from known_clique, the size of a clique already found.
+template <typename F>
+auto with_root_state(const UndirectedGraph& graph, const CliqueOptions& options, F f,
+                     unsigned known_clique = 0) {
+    bool maxsat = options.bound == CliqueBound::MaxSat;
+    if (options.representation == CliqueRepresentation::Bitset) {
+        // Its relabeled copy of the graph always has a bit matrix.
+        if (UndirectedGraph::matrix_bytes(graph.vertices()) > UndirectedGraph::matrix_max_bytes) {
+            throw domain_error("The bitset state needs a bit matrix too large for this graph.");
+        }
+        auto state = root_state<BitsetCliqueState>(graph, maxsat, known_clique);
+        return f(&state);
+    }
+    if (maxsat) { throw domain_error("The MaxSAT bound needs the bitset state."); }
+    auto state = root_state<MaximumCliqueState>(graph);
+    return f(&state);
 }
 
 
-vector<MaximumCliqueSol> solve_backtrack(const UndirectedGraph& graph, unsigned log_frequency) {
-    vector<unsigned> initial_order;
-    auto state = root_state(graph, &initial_order);
-    state.sort_and_imply();
-    Solver<MaximumCliqueState, Sense::Maximize> solver(&state);
-    solver.solve(log_frequency);
-    return solver.get_solutions();
+// Clique found by the heuristic, if it is on and finds one.
+optional<MaximumCliqueSol> heuristic_incumbent(
+        const UndirectedGraph& graph, const CliqueOptions& options) {
+    auto clique = heuristic_clique(graph, options.heuristic);
+    if (clique.empty()) { return nullopt; }
+    return MaximumCliqueSol(begin(clique), end(clique));
+}
+
+
+// Size of the clique, or 0 if there is none.
+unsigned clique_size(const optional<MaximumCliqueSol>& clique) {
+    return clique ? clique->get_objective_value() : 0;
+}
+
+
+template <typename Pool>
+vector<MaximumCliqueSol> to_vector(const Pool& pool) {
+    return vector<MaximumCliqueSol>(begin(pool), end(pool));
+}
+
+
+CliqueRepresentation parse_clique_representation(const string& name) {
+    if (name == "vector") { return CliqueRepresentation::Vector; }
+    if (name == "bitset") { return CliqueRepresentation::Bitset; }
+    throw domain_error("Bad state representation choice.");
+}
+
+
+CliqueBound parse_clique_bound(const string& name) {
+    if (name == "colouring") { return CliqueBound::Colouring; }
+    if (name == "maxsat") { return CliqueBound::MaxSat; }
+    throw domain_error("Bad bound choice.");
+}
+
+
+optional<MaximumCliqueSol> solve_recursive(
+        const UndirectedGraph& graph, const CliqueOptions& options) {
+    auto incumbent = heuristic_incumbent(graph, options);
+    return with_root_state(graph, options, [&incumbent](auto* state) {
+        using State = remove_pointer_t<decltype(state)>;
+        return incumbent
+            ? solve_recursive<State, Sense::Maximize>(state, *incumbent)
+            : solve_recursive<State, Sense::Maximize>(state);
+    }, clique_size(incumbent));
+}
+
+
+optional<MaximumCliqueSol> solve_recursive_parallel(
+        const UndirectedGraph& graph, unsigned threads, const CliqueOptions& options) {
+    auto incumbent = heuristic_incumbent(graph, options);
+    return with_root_state(graph, options, [threads, &incumbent](auto* state) {
+        using State = remove_pointer_t<decltype(state)>;
+        return incumbent
+            ? solve_recursive_parallel<State, Sense::Maximize>(state, threads, 12, *incumbent)
+            : solve_recursive_parallel<State, Sense::Maximize>(state, threads, 12);
+    }, clique_size(incumbent));
+}
+
+
+template <typename Profiler, typename State>
+vector<MaximumCliqueSol> solve_backtrack(
+        State* state, const LogOptions& log, const SearchLimits& limits, size_t pool_size,
+        const string& trace, const optional<MaximumCliqueSol>& incumbent) {
+    Solver<State, Sense::Maximize, KeepTopK<MaximumCliqueSol>, Profiler>
+        solver(state, KeepTopK<MaximumCliqueSol>(pool_size));
+    if (!trace.empty()) { solver.set_trace(trace); }
+    if (incumbent) { solver.set_incumbent(*incumbent); }
+    solver.solve(log, limits);
+    return to_vector(solver.get_solutions());
+}
+
+
+vector<MaximumCliqueSol> solve_backtrack(
+        const UndirectedGraph& graph, const LogOptions& log,
+        const SearchLimits& limits, size_t pool_size, bool profile,
+        const string& trace, const CliqueOptions& options) {
+    auto incumbent = heuristic_incumbent(graph, options);
+    return with_root_state(graph, options, [&](auto* state) {
+        return profile
+            ? solve_backtrack<PerfProfiler>(state, log, limits, pool_size, trace, incumbent)
+            : solve_backtrack<NoProfiler>(state, log, limits, pool_size, trace, incumbent);
+    }, clique_size(incumbent));
+}
+
+
+void replay_search_trace(
+        const UndirectedGraph& graph, const LogOptions& log, const string& trace,
+        const CliqueOptions& options) {
+    with_root_state(graph, options, [&log, &trace](auto* state) {
+        log_replay(log, replay_trace(state, trace));
+    });
+}
+
+
+vector<string> split_subproblems(
+        const UndirectedGraph& graph, unsigned n, const CliqueOptions& options) {
+    return with_root_state(graph, options, [n](auto* state) {
+        return split_prefixes(state, n);
+    });
+}
+
+
+vector<MaximumCliqueSol> solve_subproblem(
+        const UndirectedGraph& graph, const LogOptions& log, const SearchLimits& limits,
+        const string& prefix, optional<unsigned> primal_bound,
+        const CliqueOptions& options) {
+    // The heuristic's clique need not be in the subtree, but it is reported
+    // (as by the parent search) if it beats the given bound.
+    auto incumbent = heuristic_incumbent(graph, options);
+    return with_root_state(graph, options, [&](auto* state) {
+        using State = remove_pointer_t<decltype(state)>;
+        PrefixPath<State> path(state);
+        Solver<State, Sense::Maximize> solver(state);
+        if (primal_bound) { solver.set_primal_bound(*primal_bound); }
+        if (incumbent && (!primal_bound || incumbent->get_objective_value() > *primal_bound)) {
+            solver.set_incumbent(*incumbent);
+        }
+        if (!path.apply(prefix)) {
+            throw domain_error("Prefix is not in the search tree.");
+        }
+        solver.solve(log, limits);
+        return to_vector(solver.get_solutions());
+    }, max(clique_size(incumbent), primal_bound.value_or(0)));
+}
+
+
+vector<MaximumCliqueSol> solve_parallel(
+        const UndirectedGraph& graph, unsigned threads, const CliqueOptions& options) {
+    auto incumbent = heuristic_incumbent(graph, options);
+    return with_root_state(graph, options, [threads, &incumbent](auto* state) {
+        using State = remove_pointer_t<decltype(state)>;
+        ParallelSolver<State, Sense::Maximize> solver(state, threads);
+        if (incumbent) { solver.set_incumbent(*incumbent); }
+        solver.solve();
+        return to_vector(solver.get_solutions());
+    }, clique_size(incumbent));
+}
+
+
+vector<MaximumCliqueSol> solve_bestfirst(
+        const UndirectedGraph& graph, size_t max_open, const CliqueOptions& options) {
+    auto incumbent = heuristic_incumbent(graph, options);
+    return with_root_state(graph, options, [max_open, &incumbent](auto* state) {
+        using State = remove_pointer_t<decltype(state)>;
+        BestFirstSolver<State, Sense::Maximize> solver(state, max_open, 8);
+        if (incumbent) { solver.set_incumbent(*incumbent); }
+        solver.solve();
+        return to_vector(solver.get_solutions());
+    }, clique_size(incumbent));
 }
 
 
 // definitely can be improved (don't copy out the solution, just leave partitioned?)
 vector<unsigned>::iterator solve_subgraph(const UndirectedGraph& graph, vector<unsigned>* vertices) {
-    MaximumCliqueState state(graph, begin(*vertices), end(*vertices));
+    MaximumCliqueState state(graph, *vertices);
     state.sort_and_imply();
     auto solution = solve_recursive<MaximumCliqueState, Sense::Maximize>(&state);
     return partition(begin(*vertices), end(*vertices), [solution](unsigned u) {
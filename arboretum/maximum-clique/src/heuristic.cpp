@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "../include/heuristic.hpp"
+
+using namespace std;
+
+
+namespace {
+
+// Swaps in a row without a larger clique before restarting.
+constexpr unsigned plateau_steps = 100;
+// Greedy constructions, from this many of the highest degree vertices.
+constexpr unsigned greedy_starts = 32;
+
+
+// A clique, with the number of members each vertex is adjacent to, so that
+// vertices which extend it or can be swapped into it are found by scanning
+// the neighbours of two members (any such vertex is adjacent to one of
+// them). Moves cost the degree of the vertex moved.
+class CliqueSearch {
+    const UndirectedGraph& graph;
+    vector<unsigned> clique;
+    vector<unsigned> hits;
+    vector<char> member;
+    // Stamps of vertices seen by the current scan.
+    vector<unsigned> seen;
+    unsigned pass;
+
+public:
+    explicit CliqueSearch(const UndirectedGraph& g) :
+        graph(g), clique(), hits(g.vertices(), 0), member(g.vertices(), 0),
+        seen(g.vertices(), 0), pass(0) {}
+
+    const vector<unsigned>& get() const { return clique; }
+    size_t size() const { return clique.size(); }
+
+    void add(unsigned v) {
+        member[v] = 1;
+        clique.push_back(v);
+        for (auto w : graph[v]) { hits[w]++; }
+    }
+
+    void remove(unsigned v) {
+        member[v] = 0;
+        clique.erase(find(begin(clique), end(clique), v));
+        for (auto w : graph[v]) { hits[w]--; }
+    }
+
+    void clear() {
+        while (!clique.empty()) { remove(clique.back()); }
+    }
+
+    // Keep only the members adjacent to v (so not v itself).
+    void keep_adjacent(unsigned v) {
+        auto members = clique;
+        for (auto u : members) {
+            if (!graph.adjacent(u, v)) { remove(u); }
+        }
+    }
+
+    // The member not adjacent to v, a vertex adjacent to all but one.
+    unsigned conflict(unsigned v) const {
+        for (auto u : clique) {
+            if (!graph.adjacent(u, v)) { return u; }
+        }
+        return v;
+    }
+
+    // Vertices adjacent to every member (add), or to all but one (swap,
+    // only for cliques of two or more, leaving out tabu).
+    void candidates(vector<unsigned>* add, vector<unsigned>* swap, unsigned tabu) {
+        add->clear();
+        swap->clear();
+        if (clique.empty()) { return; }
+        if (++pass == 0) {
+            fill(begin(seen), end(seen), 0);
+            pass = 1;
+        }
+        // The two members of smallest degree are the cheapest to scan.
+        unsigned a = clique[0];
+        unsigned b = clique[0];
+        for (auto u : clique) {
+            if (graph.degree(u) < graph.degree(a)) {
+                b = a;
+                a = u;
+            } else if (b == a || graph.degree(u) < graph.degree(b)) {
+                b = u;
+            }
+        }
+        unsigned full = clique.size();
+        for (auto u : {a, b}) {
+            for (auto w : graph[u]) {
+                if (seen[w] == pass || member[w]) { continue; }
+                seen[w] = pass;
+                if (hits[w] == full) {
+                    add->push_back(w);
+                } else if (full > 1 && hits[w] + 1 == full && w != tabu) {
+                    swap->push_back(w);
+                }
+            }
+            if (a == b) { break; }
+        }
+    }
+};
+
+}  // namespace
+
+
+vector<unsigned> heuristic_clique(const UndirectedGraph& graph, const HeuristicLimits& limits) {
+    const unsigned n = graph.vertices();
+    if (n == 0 || limits.steps == 0) { return {}; }
+    auto start = chrono::steady_clock::now();
+    CliqueSearch search(graph);
+    vector<unsigned> best;
+    vector<unsigned> add;
+    vector<unsigned> swap;
+
+    // Greedy: repeatedly add the extending vertex of highest degree.
+    vector<unsigned> starts(n);
+    for (unsigned v = 0; v < n; v++) { starts[v] = v; }
+    auto count = min<size_t>(greedy_starts, n);
+    partial_sort(begin(starts), begin(starts) + count, end(starts), [&graph](unsigned u, unsigned v) {
+        return graph.degree(u) != graph.degree(v) ? graph.degree(u) > graph.degree(v) : u < v;
+    });
+    for (size_t i = 0; i < count; i++) {
+        search.clear();
+        search.add(starts[i]);
+        for (search.candidates(&add, &swap, n); !add.empty(); search.candidates(&add, &swap, n)) {
+            search.add(*max_element(begin(add), end(add), [&graph](unsigned u, unsigned v) {
+                return graph.degree(u) != graph.degree(v) ? graph.degree(u) < graph.degree(v) : u > v;
+            }));
+        }
+        if (search.size() > best.size()) { best = search.get(); }
+    }
+
+    // Plateau search from the best greedy clique.
+    search.clear();
+    for (auto v : best) { search.add(v); }
+    mt19937 random(1);
+    unsigned plateau = 0;
+    unsigned tabu = n;
+    for (unsigned long step = 0; step < limits.steps; step++) {
+        if ((step & 255) == 0 && chrono::duration<double>(
+                chrono::steady_clock::now() - start).count() >= limits.time) {
+            break;
+        }
+        search.candidates(&add, &swap, tabu);
+        if (!add.empty()) {
+            search.add(add[random() % add.size()]);
+            if (search.size() > best.size()) {
+                best = search.get();
+                plateau = 0;
+            }
+        } else if (!swap.empty() && plateau < plateau_steps) {
+            auto v = swap[random() % swap.size()];
+            tabu = search.conflict(v);
+            search.remove(tabu);
+            search.add(v);
+            plateau++;
+        } else {
+            // Restart from a random vertex and its neighbours in the clique.
+            unsigned v = random() % n;
+            search.keep_adjacent(v);
+            search.add(v);
+            plateau = 0;
+            tabu = n;
+        }
+    }
+    return best;
+}
@@ -1,38 +1,228 @@
 
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <sstream>
 #include <string>
+#include <vector>
 
 #include <cxxopts.hpp>
 
+#include <arbory/coordinator.hpp>
+#include <arbory/struct/relabel.hpp>
+
 #include "../include/algorithm.hpp"
 
 using namespace std;
 
+static atomic<bool> interrupted(false);
+
+
+// Solution in the numbering of the input file.
+MaximumCliqueSol to_original(const RelabeledGraph& relabeled, const MaximumCliqueSol& solution) {
+    auto vertices = relabeled.original(solution.get());
+    return MaximumCliqueSol(begin(vertices), end(vertices));
+}
+
+
+void handle_interrupt(int) {
+    interrupted = true;
+}
+
 
 int main(int argc, char **argv) {
     cxxopts::Options options("Arbory MaxClique", "Exact Maximum Clique Solver");
     options.add_options()
-        ("f,file", "Input File", cxxopts::value<string>())
-        ("l,log", "Node Log Frequency", cxxopts::value<unsigned>())
+        ("f,file", "Input File (DIMACS or binary graph)", cxxopts::value<string>())
+        ("l,log", "Log Interval (seconds)", cxxopts::value<double>())
         ("m,mode", "Tree Search Mode", cxxopts::value<string>())
+        ("t,threads", "Worker Threads", cxxopts::value<unsigned>()->default_value("1"))
+        ("max-open", "Best-First Open Node Limit", cxxopts::value<size_t>()->default_value("1000000"))
+        ("time-limit", "Time Limit (seconds)", cxxopts::value<double>())
+        ("node-limit", "Node Limit", cxxopts::value<unsigned long>())
+        ("gap", "Absolute Gap Limit", cxxopts::value<double>())
+        ("rel-gap", "Relative Gap Limit", cxxopts::value<double>())
+        ("log-format", "Log Format (text/json)", cxxopts::value<string>()->default_value("text"))
+        ("report", "JSON Report File", cxxopts::value<string>())
+        ("pool", "Solution Pool Size", cxxopts::value<size_t>()->default_value("1"))
+        ("split", "Split Into Subproblems (print prefixes)", cxxopts::value<unsigned>())
+        ("processes", "Solve Split Subproblems Using Child Processes", cxxopts::value<unsigned>())
+        ("subproblem-time", "Time Limit Per Child Process Before Resplitting", cxxopts::value<double>())
+        ("subproblem", "Solve Only The Subtree At This Prefix", cxxopts::value<string>())
+        ("primal-bound", "Initial Primal Bound", cxxopts::value<double>())
+        ("profile", "Report Hardware Counters Per Search Phase")
+        ("state", "Search State Representation (vector/bitset)",
+         cxxopts::value<string>()->default_value("vector"))
+        ("bound", "Upper Bound (colouring/maxsat, maxsat needs the bitset state)",
+         cxxopts::value<string>()->default_value("colouring"))
+        ("heuristic-steps", "Local Search Steps Before The Exact Search (0 for none)",
+         cxxopts::value<unsigned long>()->default_value("10000"))
+        ("heuristic-time", "Time Limit Of The Local Search (seconds)", cxxopts::value<double>())
+        ("relabel", "Vertex Numbering Used By The Search (input/degree/degeneracy/rcm)",
+         cxxopts::value<string>()->default_value("input"))
+        ("trace", "Search Trace File (recorded in backtrack mode, read in replay mode)", cxxopts::value<string>())
         ;
     options.parse_positional({"file"});
     auto result = options.parse(argc, argv);
-    const auto graph = UndirectedGraph::read_dimacs(result["file"].as<string>());
-    cout << "Vertices: " << graph.vertices() << endl;
-    cout << "Edges: " << graph.edges() << endl;
+    SearchLimits limits;
+    if (result.count("time-limit")) { limits.time = result["time-limit"].as<double>(); }
+    if (result.count("node-limit")) { limits.nodes = result["node-limit"].as<unsigned long>(); }
+    if (result.count("gap")) { limits.absolute_gap = result["gap"].as<double>(); }
+    if (result.count("rel-gap")) { limits.relative_gap = result["rel-gap"].as<double>(); }
+    // Only the serial backtrack search (whole or a subproblem) checks the
+    // limits and the interrupt flag, and the coordinator stops its children
+    // when the flag is set; SIGINT ends the other modes as usual.
+    auto threads = result["threads"].as<unsigned>();
+    bool limited = !result.count("split") && result.count("mode")
+        && result["mode"].as<string>() == "backtrack" && (threads == 1 || result.count("subproblem"));
+    if (!limited && (result.count("time-limit") || result.count("node-limit")
+                     || result.count("gap") || result.count("rel-gap"))) {
+        throw domain_error("Search limits require single-threaded backtrack mode.");
+    }
+    limits.interrupt = &interrupted;
+    if (limited || result.count("processes")) { signal(SIGINT, handle_interrupt); }
+    install_snapshot_signal(SIGUSR1);
+    LogOptions log(result.count("log") ? result["log"].as<double>() : 0);
+    if (result["log-format"].as<string>() == "json") {
+        log.format = LogFormat::JSON;
+    } else if (result["log-format"].as<string>() != "text") {
+        throw domain_error("Bad log format choice.");
+    }
+    unique_ptr<ofstream> report;
+    if (result.count("report")) {
+        report = make_unique<ofstream>(result["report"].as<string>());
+        log.report = report.get();
+    }
+    // Solutions are mapped back to the input numbering for output.
+    auto relabel = result["relabel"].as<string>();
+    const RelabeledGraph relabeled(
+        UndirectedGraph::read(result["file"].as<string>()), parse_vertex_order(relabel));
+    const auto& graph = relabeled.graph();
+    auto state_name = result["state"].as<string>();
+    auto bound_name = result["bound"].as<string>();
+    CliqueOptions clique_options;
+    clique_options.representation = parse_clique_representation(state_name);
+    clique_options.bound = parse_clique_bound(bound_name);
+    clique_options.heuristic.steps = result["heuristic-steps"].as<unsigned long>();
+    if (result.count("heuristic-time")) {
+        clique_options.heuristic.time = result["heuristic-time"].as<double>();
+    }
+    if (log.format == LogFormat::JSON) {
+        cout << "{\"event\": \"instance\", \"file\": " << json_string(result["file"].as<string>())
+             << ", \"vertices\": " << graph.vertices()
+             << ", \"edges\": " << graph.edges() << "}" << endl;
+    } else {
+        cout << "Vertices: " << graph.vertices() << endl;
+        cout << "Edges: " << graph.edges() << endl;
+    }
+    if (result.count("split")) {
+        auto prefixes = split_subproblems(graph, result["split"].as<unsigned>(), clique_options);
+        if (!result.count("processes")) {
+            for (const auto& prefix : prefixes) {
+                cout << prefix << endl;
+            }
+            return 0;
+        }
+        auto file = result["file"].as<string>();
+        auto time = result.count("subproblem-time")
+            ? optional<double>(result["subproblem-time"].as<double>()) : nullopt;
+        auto heuristic = clique_options.heuristic;
+        auto command = [file, time, relabel, state_name, bound_name, heuristic](
+                const string& prefix, optional<double> bound, const string& report) {
+            vector<string> args = {"/proc/self/exe", file, "--mode=backtrack",
+                                   "--log-format=json", "--subproblem=" + prefix,
+                                   "--report=" + report, "--relabel=" + relabel,
+                                   "--state=" + state_name, "--bound=" + bound_name};
+            if (bound) { args.push_back("--primal-bound=" + to_string(*bound)); }
+            args.push_back("--heuristic-steps=" + to_string(heuristic.steps));
+            if (isfinite(heuristic.time)) {
+                args.push_back("--heuristic-time=" + to_string(heuristic.time));
+            }
+            if (time) { args.push_back("--time-limit=" + to_string(*time)); }
+            return args;
+        };
+        auto outcome = coordinate_subproblems(
+            prefixes, command, result["processes"].as<unsigned>(),
+            Sense::Maximize, cout, &interrupted);
+        cout << "====== COMPLETE ======" << endl;
+        cout << "Status:      " << status_name(outcome.status) << endl;
+        cout << "Subproblems: " << outcome.subproblems << endl;
+        cout << "Resplits:    " << outcome.resplits << endl;
+        cout << "Time:        " << outcome.time << " seconds" << endl;
+        if (outcome.objective) {
+            cout << "Objective:   " << *outcome.objective << endl;
+            cout << "Prefix:      " << outcome.best_prefix << endl;
+        }
+        cout << "======================" << endl;
+        istringstream output(outcome.best_output);
+        string line;
+        while (getline(output, line)) {
+            if (line.find("\"event\": \"solution\"") != string::npos) {
+                cout << line << endl;
+            }
+        }
+        return 0;
+    }
+    if (log.format == LogFormat::JSON
+            && ((result["mode"].as<string>() != "backtrack"
+                 && result["mode"].as<string>() != "replay") || threads > 1)) {
+        throw domain_error("JSON logging requires single-threaded backtrack mode.");
+    }
+    auto trace = result.count("trace") ? result["trace"].as<string>() : string();
     if (result["mode"].as<string>() == "recursion") {
-        auto solution = solve_recursive(graph);
+        auto start = chrono::high_resolution_clock::now();
+        auto solution = (threads > 1)
+            ? solve_recursive_parallel(graph, threads, clique_options)
+            : solve_recursive(graph, clique_options);
+        double runtime = chrono::duration<double, milli>
+            (chrono::high_resolution_clock::now() - start)
+            .count() / 1000;
+        cout << "Time: " << runtime << " seconds" << endl;
         cout << "Solution:  ";
-        solution->print();
+        to_original(relabeled, *solution).print();
         cout << "  (Obj = " << solution->get_objective_value() << ")";
         cout << endl;
     } else if (result["mode"].as<string>() == "backtrack") {
-        auto solutions = solve_backtrack(graph, result["log"].as<unsigned>());
+        auto primal_bound = result.count("primal-bound")
+            ? optional<unsigned>(result["primal-bound"].as<double>()) : nullopt;
+        auto solutions = result.count("subproblem")
+            ? solve_subproblem(graph, log, limits, result["subproblem"].as<string>(),
+                               primal_bound, clique_options)
+            : (threads > 1)
+            ? solve_parallel(graph, threads, clique_options)
+            : solve_backtrack(graph, log, limits, result["pool"].as<size_t>(),
+                              result.count("profile") > 0, trace, clique_options);
+        if (log.format == LogFormat::JSON) {
+            cout << "{\"event\": \"solution\", \"clique\": [";
+            if (!solutions.empty()) {
+                const auto clique = relabeled.original(solutions.back().get());
+                for (size_t i = 0; i < clique.size(); i++) {
+                    cout << (i ? ", " : "") << clique[i];
+                }
+            }
+            cout << "]}" << endl;
+            return 0;
+        }
+        cout << "Solution Pool: " << endl;
+        for (const auto& solution : solutions) {
+            cout << "  (Obj = " << solution.get_objective_value() << ")  ";
+            to_original(relabeled, solution).print();
+            cout << endl;
+        }
+    } else if (result["mode"].as<string>() == "replay") {
+        if (trace.empty()) { throw domain_error("Replay requires a trace file."); }
+        replay_search_trace(graph, log, trace, clique_options);
+    } else if (result["mode"].as<string>() == "bestfirst") {
+        auto solutions = solve_bestfirst(graph, result["max-open"].as<size_t>(), clique_options);
         cout << "Solution Pool: " << endl;
         for (const auto& solution : solutions) {
             cout << "  (Obj = " << solution.get_objective_value() << ")  ";
-            solution.print();
+            to_original(relabeled, solution).print();
             cout << endl;
         }
     } else {
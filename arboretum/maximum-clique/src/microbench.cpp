@@ -0,0 +1,80 @@
+
+#define ARBORY_MICROBENCH_MAIN
+
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <arbory/microbench.hpp>
+#include <arbory/sense.hpp>
+
+#include "../include/state.hpp"
+
+using namespace std;
+
+// Keeps results of const primitives alive.
+static volatile unsigned long sink;
+
+
+void bench_instance(const string& file_name) {
+    const auto graph = UndirectedGraph::read_dimacs(file_name);
+    vector<unsigned> order(graph.vertices());
+    for (unsigned i = 0; i < graph.vertices(); i++) { order[i] = i; }
+    MaximumCliqueState root(graph, order);
+    root.sort_and_imply();
+    auto paths = sample_paths<MaximumCliqueState, Sense::Maximize>(&root, 1000, 1000000);
+    auto sampled = sample_states(&root, paths);
+
+    // Branching primitives need non-leaf states and their branch vertex.
+    struct Item {
+        MaximumCliqueState state;
+        unsigned vertex;
+    };
+    vector<Item> items;
+    for (auto& state : sampled) {
+        if (state.is_leaf()) { continue; }
+        auto [vertex, result] = state.branch();
+        state.backtrack(vertex, result);
+        items.push_back(Item{move(state), vertex});
+    }
+    vector<pair<unsigned, unsigned>> pairs;
+    mt19937 rng(0);
+    uniform_int_distribution<unsigned> vertex(0, graph.vertices() - 1);
+    for (unsigned i = 0; i < 1000; i++) {
+        pairs.emplace_back(vertex(rng), vertex(rng));
+    }
+
+    vector<MicrobenchResult> results;
+    results.push_back(measure("branch + backtrack", items, [](Item& item) {
+        auto [v, result] = item.state.branch();
+        item.state.backtrack(v, result);
+    }));
+    results.push_back(measure("branch_alternate + backtrack", items, [](Item& item) {
+        auto result = item.state.branch_alternate(item.vertex);
+        item.state.backtrack(item.vertex, result);
+    }));
+    results.push_back(measure("sort_and_imply (settled)", items, [](Item& item) {
+        item.state.sort_and_imply();
+    }));
+    results.push_back(measure("UndirectedGraph::adjacent", pairs, [&graph](pair<unsigned, unsigned>& p) {
+        sink = sink + graph.adjacent(p.first, p.second);
+    }));
+    print_results(file_name + " (" + to_string(items.size()) + " states)", results);
+}
+
+
+int main(int argc, char **argv) {
+    vector<string> files;
+    for (int i = 1; i < argc; i++) { files.push_back(argv[i]); }
+    if (files.empty()) {
+        files = {"../../instances/graphs/v100-e1902.col",
+                 "../../instances/graphs/miles250.col",
+                 "../../instances/graphs/2-FullIns_3.col"};
+    }
+    for (const auto& file_name : files) {
+        bench_instance(file_name);
+    }
+    return 0;
+}
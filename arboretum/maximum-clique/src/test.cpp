@@ -1,8 +1,15 @@
-
+#include <cstdio>
 #include <iostream>
+#include <string>
 #include <vector>
 
+#include <arbory/backtracking.hpp>
+#include <arbory/replay.hpp>
+#include <arbory/struct/relabel.hpp>
+
 #include "../include/algorithm.hpp"
+#include "../include/bitset_state.hpp"
+#include "../include/state.hpp"
 
 using namespace std;
 
@@ -25,6 +32,184 @@ int main() {
         edges.emplace_back(5, 8);
     UndirectedGraph graph(10, edges);
 
+    {
+        cout << "========== MATRIX ===========" << endl;
+        // The bit matrix must agree with the adjacency lists.
+        UndirectedGraph lists(10, edges, AdjacencyMatrix::Never);
+        Expects(graph.has_matrix() && !lists.has_matrix());
+        VertexSet set(10);
+        for (unsigned v : {0, 1, 5, 9}) { set.set(v); }
+        for (unsigned i = 0; i < 10; i++) {
+            for (unsigned j = 0; j < 10; j++) {
+                Expects(graph.adjacent(i, j) == lists.adjacent(i, j));
+            }
+            Expects(graph.count_neighbours(i, set) == lists.count_neighbours(i, set));
+        }
+        VertexSet common(10);
+        graph.neighbours_in(0, set, &common);
+        cout << "Neighbours of 0 in {0, 1, 5, 9}: ";
+        common.for_each([](unsigned v) { cout << v << " "; });
+        cout << endl;
+    }
+
+    {
+        cout << "=========== DIMACS ===========" << endl;
+        // Comments, tabs, carriage returns and a repeated edge are tolerated.
+        string file = "test.col";
+        FILE* out = fopen(file.c_str(), "w");
+        fputs("c test graph\n  p col 10 14\r\n", out);
+        for (auto [i, j] : edges) { fprintf(out, "e\t%u  %u\r\n", i + 1, j + 1); }
+        fputs("e 1 2\nc end\n", out);
+        fclose(out);
+        for (unsigned threads : {1, 3}) {
+            auto read = UndirectedGraph::read_dimacs(file, threads);
+            Expects(read.vertices() == 10 && read.edges() == edges.size());
+            for (unsigned i = 0; i < 10; i++) {
+                for (unsigned j = 0; j < 10; j++) {
+                    Expects(read.adjacent(i, j) == graph.adjacent(i, j));
+                }
+            }
+        }
+        remove(file.c_str());
+        cout << "Read " << graph.edges() << " edges." << endl;
+    }
+
+    {
+        cout << "=========== BINARY ===========" << endl;
+        // Mapped graphs must match the written ones, with or without matrix.
+        string file = "test.bin";
+        for (auto matrix : {AdjacencyMatrix::Always, AdjacencyMatrix::Never}) {
+            UndirectedGraph(10, edges, matrix).write_binary(file);
+            auto read = UndirectedGraph::read(file);
+            Expects(read.vertices() == 10 && read.edges() == graph.edges());
+            Expects(read.has_matrix() == (matrix == AdjacencyMatrix::Always));
+            for (unsigned i = 0; i < 10; i++) {
+                Expects(read.degree(i) == graph.degree(i));
+                for (unsigned j = 0; j < 10; j++) {
+                    Expects(read.adjacent(i, j) == graph.adjacent(i, j));
+                }
+            }
+        }
+        auto copy = UndirectedGraph::read_binary(file);
+        remove(file.c_str());
+        cout << "Mapped " << copy.edges() << " edges." << endl;
+    }
+
+    {
+        cout << "=========== RELABEL ==========" << endl;
+        // Cliques found in relabeled graphs must map back to cliques of the
+        // same size.
+        auto best = solve_backtrack(graph, 0).back().get_objective_value();
+        for (const string name : {"input", "degree", "degeneracy", "rcm"}) {
+            RelabeledGraph relabeled(graph, parse_vertex_order(name));
+            const auto& other = relabeled.graph();
+            Expects(other.edges() == graph.edges());
+            for (unsigned i = 0; i < 10; i++) {
+                for (unsigned j = 0; j < 10; j++) {
+                    Expects(other.adjacent(i, j) == graph.adjacent(
+                        relabeled.original(i), relabeled.original(j)));
+                }
+            }
+            auto clique = relabeled.original(solve_backtrack(other, 0).back().get());
+            Expects(clique.size() == best);
+            for (auto u : clique) {
+                for (auto v : clique) { Expects(u == v || graph.adjacent(u, v)); }
+            }
+            cout << name << ": ";
+            for (auto v : vertex_order(graph, parse_vertex_order(name))) { cout << v << " "; }
+            cout << endl;
+        }
+    }
+
+    {
+        cout << "========== COLOURING =========" << endl;
+        // Four colours suffice for these candidates ({0, 1, 5, 9} is a
+        // clique), so the bound is 4 rather than the number of candidates,
+        // and it is restored by backtracking.
+        vector<unsigned> vertices {0, 1, 2, 5, 8, 9};
+        MaximumCliqueState state(graph, vertices);
+        state.sort_and_imply();
+        cout << "Bound: " << state.get_upper_bound() << endl;
+        Expects(state.get_upper_bound() == 4);
+        auto [vertex, result] = state.branch();
+        state.backtrack(vertex, result);
+        Expects(state.get_upper_bound() == 4);
+    }
+
+    {
+        cout << "=========== BITSET ===========" << endl;
+        // The bit-parallel state colours the same way, and every search
+        // must find a clique of the same size with it.
+        BitsetCliqueState state(graph, {0, 1, 2, 5, 8, 9});
+        state.sort_and_imply();
+        Expects(state.get_upper_bound() == 4);
+        auto [vertex, result] = state.branch();
+        state.backtrack(vertex, result);
+        Expects(state.get_upper_bound() == 4);
+        CliqueOptions bitset;
+        bitset.representation = CliqueRepresentation::Bitset;
+        auto best = solve_backtrack(graph, 0).back().get_objective_value();
+        Expects(solve_backtrack(graph, 0, SearchLimits(), 1, false, "", bitset)
+                .back().get_objective_value() == best);
+        Expects(solve_recursive(graph, bitset)->get_objective_value() == best);
+        Expects(solve_parallel(graph, 3, bitset).back().get_objective_value() == best);
+        Expects(solve_bestfirst(graph, 1000, bitset).back().get_objective_value() == best);
+        cout << "Best: " << best << endl;
+    }
+
+    {
+        cout << "=========== MAXSAT ===========" << endl;
+        // A 5-cycle needs three colours, but no clique can take a vertex
+        // from each class, so the MaxSAT bound is 2.
+        vector<pair<unsigned, unsigned>> cycle {{0, 1}, {1, 2}, {2, 3}, {3, 4}, {4, 0}};
+        UndirectedGraph pentagon(5, cycle);
+        for (bool maxsat : {false, true}) {
+            BitsetCliqueState state(pentagon, {0, 1, 2, 3, 4}, maxsat);
+            state.sort_and_imply();
+            cout << "Bound: " << state.get_upper_bound() << endl;
+            Expects(state.get_upper_bound() == (maxsat ? 2u : 3u));
+        }
+        CliqueOptions options;
+        options.representation = CliqueRepresentation::Bitset;
+        options.bound = CliqueBound::MaxSat;
+        auto best = solve_backtrack(graph, 0).back().get_objective_value();
+        Expects(solve_backtrack(graph, 0, SearchLimits(), 1, false, "", options)
+                .back().get_objective_value() == best);
+        Expects(solve_bestfirst(graph, 1000, options).back().get_objective_value() == best);
+    }
+
+    {
+        cout << "========= HEURISTIC ==========" << endl;
+        // The heuristic's clique seeds every search, which keeps it if
+        // nothing better exists.
+        HeuristicLimits limits;
+        limits.steps = 100;
+        auto clique = heuristic_clique(graph, limits);
+        for (auto u : clique) {
+            for (auto v : clique) { Expects(u == v || graph.adjacent(u, v)); }
+        }
+        auto best = solve_backtrack(graph, 0).back().get_objective_value();
+        Expects(clique.size() == best);
+        // It also starts the bitset state's MaxSAT bound.
+        CliqueOptions maxsat;
+        maxsat.representation = CliqueRepresentation::Bitset;
+        maxsat.bound = CliqueBound::MaxSat;
+        for (auto options : {CliqueOptions(), maxsat}) {
+            options.heuristic = limits;
+            Expects(solve_backtrack(graph, 0, SearchLimits(), 1, false, "", options)
+                    .back().get_objective_value() == best);
+            Expects(solve_recursive(graph, options)->get_objective_value() == best);
+            Expects(solve_recursive_parallel(graph, 3, options)->get_objective_value() == best);
+            Expects(solve_parallel(graph, 3, options).back().get_objective_value() == best);
+            Expects(solve_bestfirst(graph, 1000, options).back().get_objective_value() == best);
+            Expects(solve_subproblem(graph, 0, SearchLimits(), "", best - 1, options)
+                    .back().get_objective_value() == best);
+        }
+        cout << "Clique: ";
+        for (auto v : clique) { cout << v << " "; }
+        cout << endl;
+    }
+
     {
         cout << "========= RECURSION ==========" << endl;
         auto solution = solve_recursive(graph);
@@ -34,9 +219,49 @@ int main() {
         cout << endl;
     }
 
+    {
+        cout << "===== PARALLEL RECURSION =====" << endl;
+        auto solution = solve_recursive_parallel(graph, 4);
+        cout << "Solution: " << endl;
+        cout << "  (Obj = " << solution->get_objective_value() << ")  ";
+        solution->print();
+        cout << endl;
+    }
+
     {
         cout << "======== BACKTRACKING ========" << endl;
-        auto solutions = solve_backtrack(graph, 10);
+        auto solutions = solve_backtrack(graph, 10, SearchLimits(), 3);
+        cout << "Solution Pool: " << endl;
+        for (const auto& solution : solutions) {
+            cout << "  (Obj = " << solution.get_objective_value() << ")  ";
+            solution.print();
+            cout << endl;
+        }
+    }
+
+    {
+        cout << "======= NODE LIMITED =========" << endl;
+        SearchLimits limits;
+        limits.nodes = 6;
+        auto solutions = solve_backtrack(graph, 10, limits);
+        Expects(!solutions.empty());
+        cout << "Best: " << solutions.back().get_objective_value() << endl;
+    }
+
+    {
+        cout << "========= PARALLEL ===========" << endl;
+        auto solutions = solve_parallel(graph, 4);
+        cout << "Solution Pool: " << endl;
+        for (const auto& solution : solutions) {
+            cout << "  (Obj = " << solution.get_objective_value() << ")  ";
+            solution.print();
+            cout << endl;
+        }
+    }
+
+    {
+        cout << "========= BEST-FIRST =========" << endl;
+        auto solutions = solve_bestfirst(graph, 1000);
         cout << "Solution Pool: " << endl;
         for (const auto& solution : solutions) {
             cout << "  (Obj = " << solution.get_objective_value() << ")  ";
@@ -45,6 +270,36 @@ int main() {
         }
     }
 
+    {
+        cout << "======== SUBPROBLEMS =========" << endl;
+        optional<unsigned> best;
+        for (const auto& prefix : split_subproblems(graph, 4)) {
+            auto solutions = solve_subproblem(graph, 0, SearchLimits(), prefix, best);
+            if (!solutions.empty()) { best = solutions.back().get_objective_value(); }
+            cout << "Prefix: " << prefix << "  Best: " << best.value_or(0) << endl;
+        }
+    }
+
+    {
+        cout << "=========== TRACE ===========" << endl;
+        // Replaying must retrace the recorded search: one transition into
+        // each node visited but the root (and possibly one more, to the
+        // alternate the search stopped at once optimal), and the same leaves.
+        string trace = "test.trace";
+        MaximumCliqueState state(graph, vertex_order(graph, VertexOrder::Input));
+        state.sort_and_imply();
+        Solver<MaximumCliqueState, Sense::Maximize> solver(&state);
+        solver.set_trace(trace);
+        auto recorded = solver.solve(0);
+        auto replayed = replay_trace(&state, trace);
+        auto transitions = replayed.branches + replayed.alternates;
+        Expects(transitions + 1 == recorded.nodes || transitions == recorded.nodes);
+        Expects(replayed.leaves == solver.get_statistics().leaves);
+        solve_backtrack(graph, 0, SearchLimits(), 1, false, trace);
+        replay_search_trace(graph, 0, trace);
+        remove(trace.c_str());
+    }
+
     {
         cout << "========= SUBGRAPH ==========" << endl;
         vector<unsigned> vertices {4, 7, 5, 6, 0, 9};
@@ -2,11 +2,35 @@
 #ifndef SRC_VERTEXCOLOR_ALGORITHM_HPP_
 #define SRC_VERTEXCOLOR_ALGORITHM_HPP_
 
+#include <optional>
+#include <string>
 #include <utility>
 #include <vector>
 
+#include <arbory/checkpoint.hpp>
+#include <arbory/limits.hpp>
+#include <arbory/monitor.hpp>
+#include <arbory/statistics.hpp>
 #include <arbory/struct/graph.hpp>
 
-void solve_backtrack_vc(const UndirectedGraph& graph, unsigned log_frequency);
+#include "types.hpp"
+
+// With resume set, continues from the checkpoint file if it exists. With
+// profile set, hardware counters are reported for each search phase. With a
+// trace file, the search's transitions are recorded for replay.
+SolveResult<VertexColorSol, unsigned> solve_backtrack_vc(
+    const UndirectedGraph& graph, const LogOptions& log,
+    const SearchLimits& limits = SearchLimits(),
+    const CheckpointOptions& checkpoint = CheckpointOptions(), bool resume = false,
+    bool profile = false, const std::string& trace = "");
+// Time the transitions of a recorded search on a fresh root state.
+void replay_search_trace_vc(
+    const UndirectedGraph& graph, const LogOptions& log, const std::string& trace);
+std::vector<std::string> split_subproblems_vc(const UndirectedGraph& graph, unsigned n);
+void solve_subproblem_vc(
+    const UndirectedGraph& graph, const LogOptions& log, const SearchLimits& limits,
+    const std::string& prefix, std::optional<unsigned> primal_bound);
+void solve_parallel_vc(const UndirectedGraph& graph, unsigned threads);
+void solve_bestfirst_vc(const UndirectedGraph& graph, size_t max_open);
 
 #endif  // SRC_VERTEXCOLOR_ALGORITHM_HPP_
@@ -12,8 +12,10 @@
 
 #include <gsl/gsl_assert>
 #include <arbory/struct/graph.hpp>
+#include <arbory/trail.hpp>
 
 #include "../../maximum-clique/include/algorithm.hpp"
+#include "types.hpp"
 
 
 struct Rule {
@@ -21,22 +23,16 @@ struct Rule {
     unsigned v;
 };
 
+// A merge is recorded on the node's trail from mark: first the vertices which
+// become neighbours of u, then (from cliqueMark) the vertices added to the
+// clique.
 struct MergeResult {
-    std::vector<unsigned> makeNeighboursOfU;
-    std::vector<unsigned> addToClique;
+    UndoTrail<unsigned>::Mark mark;
+    UndoTrail<unsigned>::Mark cliqueMark;
 };
 
 struct DifferenceResult {};
 
-class VertexColorSol {
-    unsigned obj;
- public:
-    explicit VertexColorSol(unsigned v) : obj(v) {}
-    unsigned get_objective_value() const {
-        return obj;
-    }
-};
-
 #ifndef NDEBUG
 #define RUN_INVARIANT_CHECK checkInvariant();
 #else
@@ -61,6 +57,8 @@ class Node {
     std::vector<std::vector<unsigned>> neighbours;
     unsigned cliqueSize;
     unsigned mergeCount;
+    UndoTrail<unsigned> trail;
+    std::vector<unsigned> candidates;   // Scratch space for planMerge.
 
     // TODO(simonbowly) check uniqueness in graph & neighbour structures.
     // Use a constexpr to introduce these calls to allow
@@ -106,7 +104,8 @@ class Node {
  public:
     explicit Node(const UndirectedGraph& g) :
         graph(g), state(g.vertices(), non_clique),
-        neighbours(g.vertices()), cliqueSize(0), mergeCount(0) {}
+        neighbours(g.vertices()), cliqueSize(0), mergeCount(0),
+        trail(g.vertices()), candidates() {}
     Node(Node&& a) = default;
     Node& operator=(Node&& a) = default;
 
@@ -122,13 +121,15 @@ class Node {
             && (mergeCount == other.mergeCount));
     }
 
-    void initialise() {
+    void initialise(unsigned threads = 1) {
         Expects(std::all_of(
             std::begin(state), std::end(state),
             [](unsigned val) { return val == non_clique; }));
         // Initialised with n non-clique states, and n empty neighbour lists.
         // Sets the current graph clique (reset are non-clique by default).
-        auto clique = solve_recursive(graph);
+        auto clique = (threads > 1)
+            ? solve_recursive_parallel(graph, threads)
+            : solve_recursive(graph);
         for (const auto& u : clique->get()) {
             state[u] = u;
         }
@@ -179,8 +180,11 @@ class Node {
         return u;
     }
 
-    MergeResult planMerge(const Rule& choice) const {
+    // Record the plan on the trail.
+    MergeResult planMerge(const Rule& choice) {
         MergeResult plan;
+        plan.mark = trail.mark();
+        candidates.clear();
         // Non-clique neighbours of v not already neighbours of u
         // either need neighbours updated or are clique candidates.
         for (const auto& w : graph[choice.v]) {
@@ -188,39 +192,49 @@ class Node {
                 const auto& nw = neighbours[w];
                 if (std::find(nw.begin(), nw.end(), choice.u) == nw.end()) {
                     if (nw.size() == cliqueSize - 1) {
-                        plan.addToClique.push_back(w);
+                        candidates.push_back(w);
                     } else {
-                        plan.makeNeighboursOfU.push_back(w);
+                        trail.push(w);
                     }
                 }
             }
         }
-        // Divide cliqueCandidates into a sub-clique and others.
-        // Add clique to plan.addToClique and other to plan.makeNeighboursOfU.
+        // Divide clique candidates into a sub-clique and others.
+        // Add clique to the clique records and other to the neighbour records.
         // Not sure this has turned out faster than a greedy algorithm.
-        if (plan.addToClique.size() > 1) {
-            auto mid = solve_subgraph(graph, &plan.addToClique);
-            for (auto it = mid; it != std::end(plan.addToClique); ++it) {
-                plan.makeNeighboursOfU.push_back(*it);
+        auto mid = std::end(candidates);
+        if (candidates.size() > 1) {
+            mid = solve_subgraph(graph, &candidates);
+            for (auto it = mid; it != std::end(candidates); ++it) {
+                trail.push(*it);
             }
-            plan.addToClique.erase(mid, std::end(plan.addToClique));
+        }
+        plan.cliqueMark = trail.mark();
+        for (auto it = std::begin(candidates); it != mid; ++it) {
+            trail.push(*it);
         }
         return plan;
     }
 
+    // Drop the most recent plan without executing it.
+    void discardMerge(const MergeResult& plan) {
+        trail.pop_to(plan.mark);
+    }
+
     void executeMerge(const Rule& choice, const MergeResult& plan) {
         state[choice.v] = choice.u;
         mergeCount += 1;
-        for (const auto& w : plan.makeNeighboursOfU) {
+        for (const auto& w : trail.between(plan.mark, plan.cliqueMark)) {
             neighbours[w].push_back(choice.u);
         }
         // Vertex states must be updated before updating clique neighbours
         // so that state[x] == non_clique is consistent.
-        cliqueSize += plan.addToClique.size();
-        for (const auto& w : plan.addToClique) {
+        const auto addToClique = trail.since(plan.cliqueMark);
+        cliqueSize += addToClique.size();
+        for (const auto& w : addToClique) {
             state[w] = w;
         }
-        for (const auto& w : plan.addToClique) {
+        for (const auto& w : addToClique) {
             for (const auto& x : graph[w]) {
                 if (state[x] == non_clique) {
                     neighbours[x].push_back(w);
@@ -259,35 +273,38 @@ class Node {
     }
 
     // Merge v into clique vertex u.
-    MergeResult _branch(const Rule& choice) {
-        const MergeResult& plan = planMerge(choice);
+    MergeResult branch(const Rule& choice) {
+        const MergeResult plan = planMerge(choice);
         executeMerge(choice, plan);
         return plan;
     }
 
     std::pair<Rule, MergeResult> branch() {
         auto rule = branch_decision();
-        return std::make_pair(rule, _branch(rule));
+        return std::make_pair(rule, branch(rule));
     }
 
-    // Revert a call to diveMerge with the same arguments.
+    // Revert a call to diveMerge with the same arguments. The merge must be
+    // the most recent one on the trail.
     void backtrack(const Rule& choice, const MergeResult& plan) {
         // Neighbours must be removed before any states are changed so this
         // loop runs exactly as it did in the call to diveMerge().
-        for (const auto& w : plan.addToClique) {
+        const auto addToClique = trail.since(plan.cliqueMark);
+        for (const auto& w : addToClique) {
             for (const auto& x : graph[w]) {
                 if (state[x] == non_clique) {
                     neighbours[x].pop_back();
                 }
             }
         }
-        for (const auto& w : plan.addToClique) {
+        for (const auto& w : addToClique) {
             state[w] = non_clique;
         }
-        cliqueSize -= plan.addToClique.size();
-        for (const auto& w : plan.makeNeighboursOfU) {
+        cliqueSize -= addToClique.size();
+        for (const auto& w : trail.between(plan.mark, plan.cliqueMark)) {
             neighbours[w].pop_back();
         }
+        trail.pop_to(plan.mark);
         state[choice.v] = non_clique;
         mergeCount -= 1;
         RUN_INVARIANT_CHECK
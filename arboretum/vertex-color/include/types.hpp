@@ -0,0 +1,13 @@
+#ifndef SRC_VERTEXCOLOR_TYPES_HPP_
+#define SRC_VERTEXCOLOR_TYPES_HPP_
+
+class VertexColorSol {
+    unsigned obj;
+ public:
+    explicit VertexColorSol(unsigned v) : obj(v) {}
+    unsigned get_objective_value() const {
+        return obj;
+    }
+};
+
+#endif  // SRC_VERTEXCOLOR_TYPES_HPP_
@@ -1,5 +1,10 @@
 
 #include "arbory/backtracking.hpp"
+#include "arbory/bestfirst.hpp"
+#include "arbory/decomposition.hpp"
+#include "arbory/parallel.hpp"
+#include "arbory/profile.hpp"
+#include "arbory/replay.hpp"
 
 #include "../include/algorithm.hpp"
 #include "../include/state.hpp"
@@ -7,10 +12,84 @@
 using namespace std;
 
 
-void solve_backtrack_vc(const UndirectedGraph& graph, unsigned log_frequency) {
+template <typename Profiler>
+SolveResult<VertexColorSol, unsigned> solve_backtrack_vc(
+        Node* root, const LogOptions& log, const SearchLimits& limits,
+        const CheckpointOptions& checkpoint, bool resume, const string& trace) {
+    Solver<Node, Sense::Minimize, KeepBest<VertexColorSol>, Profiler> solver(root);
+    solver.set_checkpoint(checkpoint);
+    if (!trace.empty()) { solver.set_trace(trace); }
+    if (resume && solver.resume(checkpoint.file)) {
+        *log.stream << ((log.format == LogFormat::JSON)
+            ? "{\"event\": \"resume\"}" : "Resumed from checkpoint.") << endl;
+    }
+    return solver.solve(log, limits);
+}
+
+
+SolveResult<VertexColorSol, unsigned> solve_backtrack_vc(
+        const UndirectedGraph& graph, const LogOptions& log, const SearchLimits& limits,
+        const CheckpointOptions& checkpoint, bool resume, bool profile,
+        const string& trace) {
     Node root(graph);
     root.initialise();
-    cout << "Clique: " << root.get_lower_bound() << endl;
+    if (log.format == LogFormat::JSON) {
+        *log.stream << "{\"event\": \"clique\", \"size\": " << root.get_lower_bound()
+                    << "}" << endl;
+    } else {
+        *log.stream << "Clique: " << root.get_lower_bound() << endl;
+    }
+    if (profile) {
+        return solve_backtrack_vc<PerfProfiler>(&root, log, limits, checkpoint, resume, trace);
+    } else {
+        return solve_backtrack_vc<NoProfiler>(&root, log, limits, checkpoint, resume, trace);
+    }
+}
+
+
+void replay_search_trace_vc(
+        const UndirectedGraph& graph, const LogOptions& log, const string& trace) {
+    Node root(graph);
+    root.initialise();
+    log_replay(log, replay_trace(&root, trace));
+}
+
+
+vector<string> split_subproblems_vc(const UndirectedGraph& graph, unsigned n) {
+    Node root(graph);
+    root.initialise();
+    return split_prefixes(&root, n);
+}
+
+
+void solve_subproblem_vc(
+        const UndirectedGraph& graph, const LogOptions& log, const SearchLimits& limits,
+        const string& prefix, optional<unsigned> primal_bound) {
+    Node root(graph);
+    root.initialise();
+    PrefixPath<Node> path(&root);
     Solver<Node, Sense::Minimize> solver(&root);
-    solver.solve(log_frequency);
+    if (primal_bound) { solver.set_primal_bound(*primal_bound); }
+    if (!path.apply(prefix)) {
+        throw domain_error("Prefix is not in the search tree.");
+    }
+    solver.solve(log, limits);
+}
+
+
+void solve_parallel_vc(const UndirectedGraph& graph, unsigned threads) {
+    Node root(graph);
+    root.initialise(threads);
+    cout << "Clique: " << root.get_lower_bound() << endl;
+    ParallelSolver<Node, Sense::Minimize> solver(&root, threads);
+    solver.solve();
+}
+
+
+void solve_bestfirst_vc(const UndirectedGraph& graph, size_t max_open) {
+    Node root(graph);
+    root.initialise();
+    cout << "Clique: " << root.get_lower_bound() << endl;
+    BestFirstSolver<Node, Sense::Minimize> solver(&root, max_open, 8);
+    solver.solve();
 }
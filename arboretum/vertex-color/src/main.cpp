@@ -1,26 +1,168 @@
 
+#include <atomic>
+#include <csignal>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <optional>
 #include <string>
+#include <vector>
 
 #include <cxxopts.hpp>
 
+#include <arbory/coordinator.hpp>
+#include <arbory/struct/relabel.hpp>
+
 #include "../include/algorithm.hpp"
 
 using namespace std;
 
+static atomic<bool> interrupted(false);
+
+
+void handle_interrupt(int) {
+    interrupted = true;
+}
+
 
 int main(int argc, char **argv) {
     cxxopts::Options options("Arbory Vertex Coloring", "Exact Vertex Coloring Solver");
     options.add_options()
-        ("f,file", "Input File", cxxopts::value<string>())
-        ("l,log", "Node Log Frequency", cxxopts::value<unsigned>())
-        ("m,mode", "Tree Search Mode", cxxopts::value<string>())
+        ("f,file", "Input File (DIMACS or binary graph)", cxxopts::value<string>())
+        ("l,log", "Log Interval (seconds)", cxxopts::value<double>())
+        ("m,mode", "Tree Search Mode", cxxopts::value<string>()->default_value("backtrack"))
+        ("t,threads", "Worker Threads", cxxopts::value<unsigned>()->default_value("1"))
+        ("max-open", "Best-First Open Node Limit", cxxopts::value<size_t>()->default_value("1000000"))
+        ("time-limit", "Time Limit (seconds)", cxxopts::value<double>())
+        ("node-limit", "Node Limit", cxxopts::value<unsigned long>())
+        ("gap", "Absolute Gap Limit", cxxopts::value<double>())
+        ("rel-gap", "Relative Gap Limit", cxxopts::value<double>())
+        ("log-format", "Log Format (text/json)", cxxopts::value<string>()->default_value("text"))
+        ("report", "JSON Report File", cxxopts::value<string>())
+        ("split", "Split Into Subproblems (print prefixes)", cxxopts::value<unsigned>())
+        ("processes", "Solve Split Subproblems Using Child Processes", cxxopts::value<unsigned>())
+        ("subproblem-time", "Time Limit Per Child Process Before Resplitting", cxxopts::value<double>())
+        ("subproblem", "Solve Only The Subtree At This Prefix", cxxopts::value<string>())
+        ("primal-bound", "Initial Primal Bound", cxxopts::value<double>())
+        ("checkpoint", "Checkpoint File", cxxopts::value<string>())
+        ("checkpoint-interval", "Checkpoint Interval (seconds)", cxxopts::value<double>()->default_value("60"))
+        ("resume", "Resume From The Checkpoint File If It Exists")
+        ("profile", "Report Hardware Counters Per Search Phase")
+        ("relabel", "Vertex Numbering Used By The Search (input/degree/degeneracy/rcm)",
+         cxxopts::value<string>()->default_value("input"))
+        ("trace", "Search Trace File (recorded in backtrack mode, read in replay mode)", cxxopts::value<string>())
         ;
     options.parse_positional({"file"});
     auto result = options.parse(argc, argv);
-    const auto graph = UndirectedGraph::read_dimacs(result["file"].as<string>());
-    cout << "Vertices: " << graph.vertices() << endl;
-    cout << "Edges: " << graph.edges() << endl;
-    solve_backtrack_vc(graph, result["log"].as<unsigned>());
+    SearchLimits limits;
+    if (result.count("time-limit")) { limits.time = result["time-limit"].as<double>(); }
+    if (result.count("node-limit")) { limits.nodes = result["node-limit"].as<unsigned long>(); }
+    if (result.count("gap")) { limits.absolute_gap = result["gap"].as<double>(); }
+    if (result.count("rel-gap")) { limits.relative_gap = result["rel-gap"].as<double>(); }
+    // Only the serial backtrack search (whole or a subproblem) checks the
+    // limits and the interrupt flag, and the coordinator stops its children
+    // when the flag is set; SIGINT ends the other modes as usual.
+    auto threads = result["threads"].as<unsigned>();
+    bool limited = !result.count("split") && result["mode"].as<string>() == "backtrack"
+        && (threads == 1 || result.count("subproblem"));
+    if (!limited && (result.count("time-limit") || result.count("node-limit")
+                     || result.count("gap") || result.count("rel-gap"))) {
+        throw domain_error("Search limits require single-threaded backtrack mode.");
+    }
+    limits.interrupt = &interrupted;
+    if (limited || result.count("processes")) { signal(SIGINT, handle_interrupt); }
+    install_snapshot_signal(SIGUSR1);
+    LogOptions log(result.count("log") ? result["log"].as<double>() : 0);
+    if (result["log-format"].as<string>() == "json") {
+        log.format = LogFormat::JSON;
+    } else if (result["log-format"].as<string>() != "text") {
+        throw domain_error("Bad log format choice.");
+    }
+    unique_ptr<ofstream> report;
+    if (result.count("report")) {
+        report = make_unique<ofstream>(result["report"].as<string>());
+        log.report = report.get();
+    }
+    // Only objective values are reported, so nothing is mapped back.
+    auto relabel = result["relabel"].as<string>();
+    const RelabeledGraph relabeled(
+        UndirectedGraph::read(result["file"].as<string>()), parse_vertex_order(relabel));
+    const auto& graph = relabeled.graph();
+    if (log.format == LogFormat::JSON) {
+        cout << "{\"event\": \"instance\", \"file\": " << json_string(result["file"].as<string>())
+             << ", \"vertices\": " << graph.vertices()
+             << ", \"edges\": " << graph.edges() << "}" << endl;
+    } else {
+        cout << "Vertices: " << graph.vertices() << endl;
+        cout << "Edges: " << graph.edges() << endl;
+    }
+    if (result.count("split")) {
+        auto prefixes = split_subproblems_vc(graph, result["split"].as<unsigned>());
+        if (!result.count("processes")) {
+            for (const auto& prefix : prefixes) {
+                cout << prefix << endl;
+            }
+            return 0;
+        }
+        auto file = result["file"].as<string>();
+        auto time = result.count("subproblem-time")
+            ? optional<double>(result["subproblem-time"].as<double>()) : nullopt;
+        auto command = [file, time, relabel](const string& prefix, optional<double> bound,
+                                    const string& report) {
+            vector<string> args = {"/proc/self/exe", file, "--mode=backtrack",
+                                   "--log-format=json", "--subproblem=" + prefix,
+                                   "--report=" + report, "--relabel=" + relabel};
+            if (bound) { args.push_back("--primal-bound=" + to_string(*bound)); }
+            if (time) { args.push_back("--time-limit=" + to_string(*time)); }
+            return args;
+        };
+        auto outcome = coordinate_subproblems(
+            prefixes, command, result["processes"].as<unsigned>(),
+            Sense::Minimize, cout, &interrupted);
+        cout << "====== COMPLETE ======" << endl;
+        cout << "Status:      " << status_name(outcome.status) << endl;
+        cout << "Subproblems: " << outcome.subproblems << endl;
+        cout << "Resplits:    " << outcome.resplits << endl;
+        cout << "Time:        " << outcome.time << " seconds" << endl;
+        if (outcome.objective) {
+            cout << "Objective:   " << *outcome.objective << endl;
+            cout << "Prefix:      " << outcome.best_prefix << endl;
+        }
+        cout << "======================" << endl;
+        return 0;
+    }
+    if (log.format == LogFormat::JSON
+            && ((result["mode"].as<string>() != "backtrack"
+                 && result["mode"].as<string>() != "replay") || threads > 1)) {
+        throw domain_error("JSON logging requires single-threaded backtrack mode.");
+    }
+    auto trace = result.count("trace") ? result["trace"].as<string>() : string();
+    if (result["mode"].as<string>() == "bestfirst") {
+        solve_bestfirst_vc(graph, result["max-open"].as<size_t>());
+    } else if (result["mode"].as<string>() == "replay") {
+        if (trace.empty()) { throw domain_error("Replay requires a trace file."); }
+        replay_search_trace_vc(graph, log, trace);
+    } else if (result["mode"].as<string>() != "backtrack") {
+        throw domain_error("Bad mode choice.");
+    } else if (result.count("subproblem")) {
+        auto primal_bound = result.count("primal-bound")
+            ? optional<unsigned>(result["primal-bound"].as<double>()) : nullopt;
+        solve_subproblem_vc(graph, log, limits, result["subproblem"].as<string>(), primal_bound);
+    } else if (threads > 1) {
+        solve_parallel_vc(graph, threads);
+    } else {
+        CheckpointOptions checkpoint;
+        if (result.count("checkpoint")) {
+            checkpoint.file = result["checkpoint"].as<string>();
+            checkpoint.interval = result["checkpoint-interval"].as<double>();
+        } else if (result.count("resume")) {
+            throw domain_error("Resume requires a checkpoint file.");
+        }
+        if (result.count("resume") && !trace.empty()) {
+            throw domain_error("A trace must be recorded from the root, not a resumed search.");
+        }
+        solve_backtrack_vc(graph, log, limits, checkpoint, result.count("resume") > 0,
+                           result.count("profile") > 0, trace);
+    }
     return 0;
 }
@@ -0,0 +1,83 @@
+
+#define ARBORY_MICROBENCH_MAIN
+
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <arbory/microbench.hpp>
+#include <arbory/sense.hpp>
+
+#include "../include/state.hpp"
+
+using namespace std;
+
+// Keeps results of const primitives alive.
+static volatile unsigned long sink;
+
+
+void bench_instance(const string& file_name) {
+    const auto graph = UndirectedGraph::read_dimacs(file_name);
+    Node root(graph);
+    root.initialise();
+    auto paths = sample_paths<Node, Sense::Minimize>(&root, 1000, 1000000);
+    auto sampled = sample_states(&root, paths);
+
+    // Branching primitives need non-leaf states and their branch rule.
+    struct Item {
+        Node state;
+        Rule rule;
+    };
+    vector<Item> items;
+    for (auto& state : sampled) {
+        if (state.is_leaf()) { continue; }
+        Rule rule = state.branch_decision();
+        items.push_back(Item{move(state), rule});
+    }
+    vector<pair<unsigned, unsigned>> pairs;
+    mt19937 rng(0);
+    uniform_int_distribution<unsigned> vertex(0, graph.vertices() - 1);
+    for (unsigned i = 0; i < 1000; i++) {
+        pairs.emplace_back(vertex(rng), vertex(rng));
+    }
+
+    vector<MicrobenchResult> results;
+    results.push_back(measure("getMaxDSATVertex", items, [](Item& item) {
+        sink = sink + item.state.getMaxDSATVertex();
+    }));
+    results.push_back(measure("getMergeCandidate", items, [](Item& item) {
+        sink = sink + item.state.getMergeCandidate(item.rule.v);
+    }));
+    results.push_back(measure("planMerge", items, [](Item& item) {
+        item.state.discardMerge(item.state.planMerge(item.rule));
+    }));
+    results.push_back(measure("branch(rule) + backtrack", items, [](Item& item) {
+        auto result = item.state.branch(item.rule);
+        item.state.backtrack(item.rule, result);
+    }));
+    results.push_back(measure("branch_alternate + backtrack", items, [](Item& item) {
+        auto result = item.state.branch_alternate(item.rule);
+        item.state.backtrack(item.rule, result);
+    }));
+    results.push_back(measure("UndirectedGraph::adjacent", pairs, [&graph](pair<unsigned, unsigned>& p) {
+        sink = sink + graph.adjacent(p.first, p.second);
+    }));
+    print_results(file_name + " (" + to_string(items.size()) + " states)", results);
+}
+
+
+int main(int argc, char **argv) {
+    vector<string> files;
+    for (int i = 1; i < argc; i++) { files.push_back(argv[i]); }
+    if (files.empty()) {
+        files = {"../../instances/graphs/2-FullIns_3.col",
+                 "../../instances/graphs/miles250.col",
+                 "../../instances/graphs/v100-e1902.col"};
+    }
+    for (const auto& file_name : files) {
+        bench_instance(file_name);
+    }
+    return 0;
+}
@@ -1,4 +1,5 @@
 
+#include <cstdio>
 #include <iostream>
 #include <string>
 
@@ -12,7 +13,24 @@ void test_solve(string file_name) {
     const auto graph = UndirectedGraph::read_dimacs(file_name);
     cout << "Vertices: " << graph.vertices() << endl;
     cout << "Edges: " << graph.edges() << endl;
-    solve_backtrack_vc(graph, 10);
+    auto full = solve_backtrack_vc(graph, 10);
+    solve_parallel_vc(graph, 4);
+    solve_bestfirst_vc(graph, 1000);
+    // Stop early, then resume from the checkpoint: the resumed search must
+    // reach the same colouring and, carrying on from the saved path rather
+    // than revisiting the nodes before it, visit the same nodes in total.
+    CheckpointOptions checkpoint{"test.checkpoint", 60.0};
+    SearchLimits limits;
+    limits.nodes = 50;
+    auto stopped = solve_backtrack_vc(graph, 10, limits, checkpoint);
+    auto resumed = solve_backtrack_vc(graph, 10, SearchLimits(), checkpoint, true);
+    remove(checkpoint.file.c_str());
+    Expects(full.status == Status::Optimal && resumed.status == Status::Optimal);
+    Expects(resumed.primal_bound == full.primal_bound);
+    if (stopped.status == Status::NodeLimit) {
+        Expects(stopped.nodes == limits.nodes);
+        Expects(resumed.nodes == full.nodes);
+    }
 }
 
 
@@ -2,16 +2,27 @@
 #ifndef SRC_ALGORITHMS_BACKTRACKING_HPP_
 #define SRC_ALGORITHMS_BACKTRACKING_HPP_
 
+#include <algorithm>
 #include <chrono>
 #include <iostream>
+#include <memory>
 #include <optional>
+#include <sstream>
 #include <utility>
 #include <type_traits>
 #include <variant>
+#include <string>
 #include <vector>
 #include <gsl/gsl_assert>
 
+#include "checkpoint.hpp"
+#include "limits.hpp"
+#include "monitor.hpp"
+#include "profile.hpp"
 #include "sense.hpp"
+#include "sinks.hpp"
+#include "statistics.hpp"
+#include "trace.hpp"
 
 
 // Use where the distinction between main and alternate branch is
@@ -23,12 +34,27 @@ public:
     class StackNode {
         Rule rule;
         std::variant<Result, ResultAlternate> result;
+        bool donated;
     public:
         StackNode(std::pair<Rule, Result> r) :
-            rule(std::move(r.first)), result(std::move(r.second)) {}
+            rule(std::move(r.first)), result(std::move(r.second)),
+            donated(false) {}
         bool alternate_evaluated() const {
             return std::holds_alternative<ResultAlternate>(result);
         }
+        // Whether the alternate branch is still to be explored by the owner
+        // of this stack.
+        bool is_open() const { return !(donated || alternate_evaluated()); }
+        // Hand the alternate branch to another worker: unwinding this node
+        // will only revert the main branch.
+        void donate() { donated = true; }
+        // Revert the most recent transition without branching again.
+        template<typename State>
+        void backtrack(State* state) const {
+            std::visit([this, state](auto&& arg) {
+                state->backtrack(rule, arg);
+            }, result);
+        }
         // Doesn't do pre-emptive pruning.
         template<typename State>
         bool unwind_step(State* state) {
@@ -41,6 +67,7 @@ public:
                 } else {
                     // Branch 1 has been pursued, branch 2 next.
                     state->backtrack(rule, arg);
+                    if (donated) { return true; }
                     result = state->branch_alternate(rule);
                     return false;
                 }
@@ -60,15 +87,22 @@ public:
         Rule rule;
         Result result;
         bool _alternate_evaluated;
+        bool donated;
     public:
         StackNode(std::pair<Rule, Result> r) :
             rule(std::move(r.first)), result(std::move(r.second)),
-            _alternate_evaluated(false) {}
+            _alternate_evaluated(false), donated(false) {}
         bool alternate_evaluated() const { return _alternate_evaluated; }
+        bool is_open() const { return !(donated || _alternate_evaluated); }
+        void donate() { donated = true; }
+        template<typename State>
+        void backtrack(State* state) const {
+            state->backtrack(rule, result);
+        }
         template<typename State>
         bool unwind_step(State* state) {
             state->backtrack(rule, result);
-            if (_alternate_evaluated) {
+            if (_alternate_evaluated || donated) {
                 return true;
             } else {
                 result = state->branch_alternate(rule);
@@ -80,31 +114,118 @@ public:
 };
 
 
-// Should sense be a property of the state class?
-template <typename State, Sense sense>
-class Solver {
-    using opt = SenseOps<sense>;
+// Types derived from the State interface which are shared by the search
+// engines.
+template <typename State>
+struct SearchTypes {
     using Sol = typename std::invoke_result<decltype(&State::get_solution), State>::type;
     using Obj = typename std::invoke_result<decltype(&Sol::get_objective_value), Sol>::type;
     // Determine whether static or dynamic branching should be used.
-    using br_rule = typename std::invoke_result<decltype(&State::branch), State>::type::first_type;
-    using br_res = typename std::invoke_result<decltype(&State::branch), State>::type::second_type;
+    // branch() is overloaded by states which support re-entry.
+    using br_rule = typename decltype(std::declval<State&>().branch())::first_type;
+    using br_res = typename decltype(std::declval<State&>().branch())::second_type;
     using br_res_alt = typename std::invoke_result<decltype(&State::branch_alternate), State, br_rule>::type;
     using StackElement = typename std::conditional<
         std::is_same_v<br_res, br_res_alt>,
         DynamicBranching<br_rule, br_res>,
         StaticBranching<br_rule, br_res, br_res_alt>>::type::StackNode;
+};
+
+
+// Should sense be a property of the state class?
+// Improving solutions are passed to the sink (see sinks.hpp), which by
+// default keeps only the best one. The profiler (see profile.hpp) measures
+// each phase of the search loop; the default does nothing.
+template <typename State, Sense sense,
+          typename Sink = KeepBest<typename SearchTypes<State>::Sol>,
+          typename Profiler = NoProfiler>
+class Solver {
+    using opt = SenseOps<sense>;
+    using Sol = typename SearchTypes<State>::Sol;
+    using Obj = typename SearchTypes<State>::Obj;
+    using StackElement = typename SearchTypes<State>::StackElement;
+    using Rule = typename SearchTypes<State>::br_rule;
 
     State* state;
     std::vector<StackElement> stack;
-    std::vector<Sol> solutions;
+    // open_bounds[i] is the best dual bound over open nodes in stack[0..i],
+    // i.e. over parents of alternate branches still to be explored.
+    std::vector<Obj> open_bounds;
+    // Index of the lowest open stack node (stack.size() if there is none).
+    size_t first_open;
+    Sink sink;
+    unsigned long incumbents;
+    // Whether the sink holds a solution passed to set_incumbent().
+    bool seeded;
     Obj primal_bound;
+    std::chrono::time_point<std::chrono::high_resolution_clock> start;
+    SearchStatistics<Obj> statistics;
+    SearchProgress<Obj> progress;
+    // Checkpointing (see checkpoint.hpp). Nodes and completion carry over
+    // from a resumed checkpoint.
+    CheckpointOptions checkpoint;
+    std::optional<std::string> incumbent_path;
+    unsigned long initial_nodes;
+    bool complete;
+    Profiler profiler;
+    // Transitions are recorded here if set (see trace.hpp).
+    std::unique_ptr<TraceWriter<Rule>> trace;
 
 public:
-    explicit Solver(State* s) : state(s), stack(), solutions(),
-                        primal_bound(initial_primal_bound<Obj, sense>()) {}
+    explicit Solver(State* s, Sink k = Sink()) :
+        state(s), stack(), open_bounds(), first_open(0), sink(std::move(k)),
+        incumbents(0), seeded(false), primal_bound(initial_primal_bound<Obj, sense>()),
+        statistics(), progress(initial_primal_bound<Obj, sense>()),
+        checkpoint(), incumbent_path(), initial_nodes(0), complete(false),
+        profiler(), trace() {}
+
+    const auto& get_solutions() const { return sink.get_solutions(); }
+    const SearchStatistics<Obj>& get_statistics() const { return statistics; }
 
-    const std::vector<Sol>& get_solutions() const { return solutions; }
+    // Start from a known bound (e.g. the best objective found by other
+    // workers), so that only strictly better solutions are reported.
+    void set_primal_bound(Obj bound) { primal_bound = bound; }
+
+    // Start from a known solution (e.g. found by a heuristic): it is kept by
+    // the sink and its objective becomes the primal bound. Checkpoints save
+    // the bound but not the solution.
+    void set_incumbent(Sol solution) {
+        primal_bound = solution.get_objective_value();
+        sink.add(std::move(solution));
+        seeded = true;
+    }
+
+    // Periodically save the search path, bound and incumbent during solve(),
+    // and once more when it stops.
+    void set_checkpoint(CheckpointOptions options) { checkpoint = std::move(options); }
+
+    // Record every transition made by the next solve() to a trace file, which
+    // can be replayed on a fresh root by replay_trace(). The search must start
+    // at the root, so this cannot be combined with resume().
+    void set_trace(const std::string& file_name) {
+        trace = std::make_unique<TraceWriter<Rule>>(file_name);
+    }
+
+    // Restore the search from a checkpoint file before calling solve(), with
+    // the state at the root. Returns false if there is no such file.
+    bool resume(const std::string& file_name) {
+        Expects(stack.empty());
+        auto saved = Checkpoint<Obj>::read(file_name);
+        if (!saved) { return false; }
+        primal_bound = saved->primal_bound;
+        incumbent_path = saved->incumbent;
+        if (incumbent_path) {
+            restore_path(*incumbent_path);
+            Expects(state->is_leaf());
+            sink.add(state->get_solution());
+            incumbents = 1;
+            unwind_all();
+        }
+        initial_nodes = saved->nodes;
+        complete = saved->complete;
+        if (!complete) { restore_path(saved->path); }
+        return true;
+    }
 
     // Do a single backtracking step and return whether the head node
     // should be popped & unwinding should continue.
@@ -132,11 +253,123 @@ public:
     }
 
     void unwind_and_branch_alternate() {
+        size_t depth = stack.size();
         while ((stack.size() > 0) && stack.back().unwind_step(state)) {
         // while ((stack.size() > 0) && unwind_step(stack.back(), state, primal_bound)) {
             stack.pop_back();
+            open_bounds.pop_back();
         }
         Ensures((stack.size() == 0) || stack.back().alternate_evaluated());
+        if (trace) {
+            trace->backtrack(depth - stack.size());
+            if (stack.size() > 0) { trace->alternate(); }
+        }
+        // The head node is closed: its alternate branch is the current state.
+        first_open = std::min(first_open, stack.size());
+        if (first_open + 1 == stack.size()) {
+            first_open = stack.size();
+        }
+        if (open_bounds.size() > 1) {
+            open_bounds.back() = open_bounds[open_bounds.size() - 2];
+        } else if (open_bounds.size() == 1) {
+            open_bounds.back() = initial_primal_bound<Obj, sense>();
+        }
+    }
+
+    void profiled_unwind() {
+        profiler.begin();
+        unwind_and_branch_alternate();
+        profiler.end(Phase::Backtrack);
+    }
+
+    void branch() {
+        Obj bound = opt::dual_bound(*state);
+        auto child = state->branch();
+        if (trace) { trace->branch(child.first); }
+        stack.emplace_back(std::move(child));
+        open_bounds.push_back(open_bounds.empty()
+            ? bound : opt::best(open_bounds.back(), bound));
+    }
+
+    // Rebuild the stack along a path of main ('0') and alternate ('1')
+    // branches from the current (root) state.
+    void restore_path(const std::string& path) {
+        for (char c : path) {
+            Expects(state->is_feasible() && !state->is_leaf());
+            branch();
+            if (c == '1') {
+                bool popped = stack.back().unwind_step(state);
+                Ensures(!popped);
+                open_bounds.back() = (open_bounds.size() > 1)
+                    ? open_bounds[open_bounds.size() - 2]
+                    : initial_primal_bound<Obj, sense>();
+            }
+        }
+        first_open = std::min(path.find('0'), stack.size());
+    }
+
+    // Path from the root to the current state, as restored by restore_path.
+    std::string current_path() const {
+        std::string path(stack.size(), '0');
+        for (size_t i = 0; i < stack.size(); i++) {
+            if (stack[i].alternate_evaluated()) { path[i] = '1'; }
+        }
+        return path;
+    }
+
+    void save_checkpoint(unsigned long nodes, bool done) const {
+        Checkpoint<Obj> saved;
+        saved.complete = done;
+        saved.nodes = nodes;
+        saved.primal_bound = primal_bound;
+        saved.incumbent = incumbent_path;
+        if (!done) { saved.path = current_path(); }
+        saved.write(checkpoint.file);
+    }
+
+    // Revert every transition on the stack, returning to the root state.
+    void unwind_all() {
+        while (stack.size() > 0) {
+            stack.back().backtrack(state);
+            stack.pop_back();
+        }
+        open_bounds.clear();
+        first_open = 0;
+    }
+
+    // Best dual bound over the current (unexplored) state and all open stack
+    // nodes. No solution better than this remains to be found.
+    Obj global_dual_bound() const {
+        Obj bound = primal_bound;
+        if (!open_bounds.empty()) {
+            bound = opt::best(bound, open_bounds.back());
+        }
+        if (state->is_feasible()) {
+            bound = opt::best(bound, static_cast<Obj>(opt::dual_bound(*state)));
+        }
+        return bound;
+    }
+
+    double elapsed() const {
+        return std::chrono::duration<double, std::milli>
+            (std::chrono::high_resolution_clock::now() - start)
+            .count() / 1000;
+    }
+
+    // Return the reason to stop the search, if any. The clock, interrupt
+    // flag and gap are only checked every 1024 nodes or when forced.
+    std::optional<Status> check_limits(
+            const SearchLimits& limits, unsigned long nodes, bool force) const {
+        if (nodes >= limits.nodes) { return Status::NodeLimit; }
+        if (!force && (nodes & 0x3FF) != 0) { return std::nullopt; }
+        if (limits.interrupted()) { return Status::Interrupted; }
+        if (elapsed() >= limits.time) { return Status::TimeLimit; }
+        if (incumbents > 0) {
+            Obj dual_bound = global_dual_bound();
+            if (dual_bound == primal_bound) { return Status::Optimal; }
+            if (limits.gap_reached(primal_bound, dual_bound)) { return Status::GapLimit; }
+        }
+        return std::nullopt;
     }
 
     void print_stack() const {
@@ -150,77 +383,130 @@ public:
         std::cout << std::endl;
     }
 
-    std::pair<unsigned, unsigned> depths() const {
-        unsigned ldepth = 0, rdepth = 0;
-        auto it = stack.begin();
-        while (it != stack.end() && it->alternate_evaluated()) {
-            ++it;
-            ++ldepth;
+    const Profiler& get_profiler() const { return profiler; }
+
+    void log_summary(const LogOptions& log, const SolveResult<Sol, Obj>& result) const {
+        std::string profile;
+        if constexpr (Profiler::enabled) {
+            std::ostringstream out;
+            out << "\"profile\": ";
+            profiler.write_json(out, result.nodes - initial_nodes);
+            profile = out.str();
+        }
+        if (log.format == LogFormat::JSON) {
+            write_json_report(*log.stream, result, statistics, profile);
+        } else {
+            std::ostream& out = *log.stream;
+            out << "====== COMPLETE ======" << std::endl;
+            out << "Status:      " << status_name(result.status) << std::endl;
+            out << "Nodes:       " << result.nodes << std::endl;
+            out << "Solutions:   " << incumbents << std::endl;
+            out << "Time:        " << result.time << " seconds" << std::endl;
+            out << "Objective:   ";
+            if (result.solution) { out << result.primal_bound; } else { out << "none"; }
+            out << std::endl;
+            out << "Dual Bound:  " << result.dual_bound << std::endl;
+            out << "Rate:        " << (result.nodes - initial_nodes) / result.time
+                << " nodes/second" << std::endl;
+            out << "======================" << std::endl;
+            if constexpr (Profiler::enabled) {
+                profiler.write_text(out, result.nodes - initial_nodes);
+            }
         }
-        while (it != stack.end() && !it->alternate_evaluated()) {
-            ++it;
-            ++rdepth;
+        if (log.report != nullptr) {
+            write_json_report(*log.report, result, statistics, profile);
         }
-        return std::make_pair(ldepth, rdepth);
     }
 
-    void log_progress(
-        std::chrono::time_point<std::chrono::high_resolution_clock> start,
-        unsigned nodes, Obj primal_bound, bool incumbent)
-    {
-        double runtime = std::chrono::duration<double, std::milli>
-            (std::chrono::high_resolution_clock::now() - start)
-            .count() / 1000;
-        if (incumbent) { std::cout << "*"; } else { std::cout << " "; }
-        auto [ldepth, rdepth] = depths();
-        std::cout << "  TIME: " << runtime << "s"
-                << "  NODES: " << nodes
-                << "  PRIMAL: " << primal_bound
-                << "  LDEPTH: " << ldepth
-                << "  RDEPTH: " << rdepth
-                << std::endl;
-    }
-
-    void solve(unsigned int log_frequency) {
-        unsigned int nodes = 0;
-        auto start = std::chrono::high_resolution_clock::now();
-        do {
-            if (!state->is_feasible() || opt::can_be_pruned(*state, primal_bound)) {
-                // No solutions due to infeasibility, or not worth exploring
-                // due to dual bounds. Unwind.
-                unwind_and_branch_alternate();
-            } else if (state->is_leaf()) {
-                // Feasible complete solution. Add it to the pool and update
-                // the primal bound.
-                solutions.emplace_back(state->get_solution());
+    SolveResult<Sol, Obj> solve(
+            const LogOptions& log, const SearchLimits& limits = SearchLimits()) {
+        unsigned long nodes = initial_nodes;
+        std::optional<Status> stop;
+        statistics = SearchStatistics<Obj>();
+        progress.reset(primal_bound);
+        start = std::chrono::high_resolution_clock::now();
+        double next_checkpoint = checkpoint.interval;
+        profiler.start();
+        Expects(!trace || stack.empty());
+        ProgressMonitor<Obj> monitor(progress, log, start);
+        // A resumed search may already be complete.
+        if (!complete) do {
+            bool incumbent = false;
+            statistics.visit(stack.size());
+            profiler.begin();
+            bool feasible = state->is_feasible();
+            bool prunable = feasible && opt::can_be_pruned(*state, primal_bound);
+            bool leaf = feasible && !prunable && state->is_leaf();
+            profiler.end(Phase::Bound);
+            if (!feasible) {
+                // No solutions due to infeasibility. Unwind.
+                statistics.pruned_infeasible++;
+                profiled_unwind();
+            } else if (prunable) {
+                // Not worth exploring due to dual bounds. Unwind.
+                statistics.pruned_bound++;
+                profiled_unwind();
+            } else if (leaf) {
+                // Feasible complete solution. Pass it to the sink and update
+                // the primal bound, then unwind.
+                profiler.begin();
+                if (trace) { trace->leaf(); }
+                Sol solution = state->get_solution();
                 Expects(opt::is_improvement(
-                    solutions.back().get_objective_value(),
-                    primal_bound));
-                primal_bound = solutions.back().get_objective_value();
-                log_progress(start, nodes, primal_bound, true);
-                unwind_and_branch_alternate();
+                    solution.get_objective_value(), primal_bound));
+                primal_bound = solution.get_objective_value();
+                sink.add(std::move(solution));
+                incumbents++;
+                if (!checkpoint.file.empty()) { incumbent_path = current_path(); }
+                statistics.leaves++;
+                statistics.incumbents.push_back({elapsed(), nodes, primal_bound});
+                progress.primal_bound.store(primal_bound, std::memory_order_relaxed);
+                progress.incumbents.store(incumbents, std::memory_order_relaxed);
+                profiler.end(Phase::Leaf);
+                profiled_unwind();
+                incumbent = true;
             } else {
                 // Subproblem is incomplete, still improving and still feasible.
                 // Evaluate branch rule and add node to the stack.
-                stack.emplace_back(state->branch());
+                profiler.begin();
+                branch();
+                profiler.end(Phase::Branch);
             }
             nodes++;
-            if ((nodes % log_frequency) == 0) {
-                log_progress(start, nodes, primal_bound, false);
+            // Published for the monitor thread; plain stores on common hardware.
+            progress.nodes.store(nodes, std::memory_order_relaxed);
+            progress.depth.store(stack.size(), std::memory_order_relaxed);
+            progress.ldepth.store(first_open, std::memory_order_relaxed);
+            if (stack.size() > 0) {
+                stop = check_limits(limits, nodes, incumbent);
+                // Clock checked on the same schedule as the time limit.
+                if (!checkpoint.file.empty() && (nodes & 0x3FF) == 0
+                        && elapsed() >= next_checkpoint) {
+                    save_checkpoint(nodes, false);
+                    next_checkpoint = elapsed() + checkpoint.interval;
+                }
             }
-        } while (stack.size() > 0);
+        } while ((stack.size() > 0) && !stop);
+        statistics.samples = monitor.stop();
+        Status status = stop.value_or(Status::Optimal);
+        if (!checkpoint.file.empty()) {
+            save_checkpoint(nodes, status == Status::Optimal);
+        }
+        Obj dual_bound = (status == Status::Optimal) ? primal_bound : global_dual_bound();
+        unwind_all();
+        if (trace) {
+            trace->close();
+            trace.reset();
+        }
+        double runtime = elapsed();
+        statistics.samples.push_back({runtime, nodes});
+        SolveResult<Sol, Obj> result{
+            status,
+            (incumbents == 0 && !seeded) ? std::nullopt : std::optional<Sol>(sink.best()),
+            primal_bound, dual_bound, nodes, runtime};
         // Final logging statistics after completion.
-        double runtime = std::chrono::duration<double, std::milli>
-            (std::chrono::high_resolution_clock::now() - start)
-            .count() / 1000;
-        std::cout << "====== COMPLETE ======" << std::endl;
-        std::cout << "Status:      Optimal" << std::endl;
-        std::cout << "Nodes:       " << nodes << std::endl;
-        std::cout << "Solutions:   " << solutions.size() << std::endl;
-        std::cout << "Time:        " << runtime << " seconds" << std::endl;
-        std::cout << "Objective:   " << primal_bound << std::endl;
-        std::cout << "Rate:        " << nodes / runtime << " nodes/second" << std::endl;
-        std::cout << "======================" << std::endl;
+        log_summary(log, result);
+        return result;
     }
 };
 
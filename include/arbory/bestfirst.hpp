@@ -0,0 +1,313 @@
+#ifndef SRC_ARBORY_BESTFIRST_HPP_
+#define SRC_ARBORY_BESTFIRST_HPP_
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <queue>
+#include <utility>
+#include <vector>
+#include <gsl/gsl_assert>
+
+#include "backtracking.hpp"
+#include "sense.hpp"
+#include "sinks.hpp"
+
+
+// Best-bound search: open nodes are kept in a priority queue ordered on their
+// dual bound, so the node with the best potential objective is always
+// explored next. Optimality is proven as soon as the best open bound cannot
+// improve on the incumbent.
+//
+// Open nodes are stored as decision paths rather than states. A single
+// working state is moved between nodes by backtracking to the common
+// ancestor and replaying decisions, or by restoring the nearest stored
+// snapshot on the target's path and replaying from there, whichever takes
+// fewer transitions. The root is always a snapshot; further snapshots are
+// taken every snapshot_interval levels (0 disables them).
+//
+// Open nodes and stored snapshots (whose path nodes stay alive while any
+// open node below them does) count together against max_open. When they
+// reach it the best node is instead solved by depth-first search, and no
+// further snapshots are taken, so memory use is capped.
+//
+// Required methods (in addition to those used by Solver):
+//
+//      State:
+//          State clone() const
+//          Result branch(const Rule&)      // re-enter a main branch
+//
+// Replay requires branch() to be deterministic given the set of decisions
+// made on the path to a node.
+template <typename State, Sense sense,
+          typename Sink = KeepBest<typename SearchTypes<State>::Sol>>
+class BestFirstSolver {
+    using opt = SenseOps<sense>;
+    using Sol = typename SearchTypes<State>::Sol;
+    using Obj = typename SearchTypes<State>::Obj;
+    using Rule = typename SearchTypes<State>::br_rule;
+    using Result = typename SearchTypes<State>::br_res;
+    using ResultAlternate = typename SearchTypes<State>::br_res_alt;
+    using StackElement = typename SearchTypes<State>::StackElement;
+
+    // A stored state, counted in *live while it exists.
+    struct Snapshot {
+        State state;
+        size_t* live;
+        Snapshot(State s, size_t* l) : state(std::move(s)), live(l) { ++*live; }
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+        ~Snapshot() { --*live; }
+    };
+
+    // Node of the search tree on the path to some open node.
+    struct PathNode {
+        std::shared_ptr<PathNode> parent;
+        std::optional<Rule> rule;       // nullopt at the root
+        bool alternate;
+        unsigned depth;
+        std::unique_ptr<Snapshot> snapshot;
+    };
+
+    struct OpenNode {
+        Obj bound;
+        std::shared_ptr<PathNode> node;
+    };
+
+    // Best bound first, deeper nodes first among equal bounds.
+    struct OpenNodeOrder {
+        bool operator()(const OpenNode& a, const OpenNode& b) const {
+            if (a.bound == b.bound) {
+                return a.node->depth < b.node->depth;
+            }
+            return opt::is_improvement(b.bound, a.bound);
+        }
+    };
+
+    // Transition applied to the working state, kept for backtracking.
+    struct Step {
+        std::shared_ptr<PathNode> node;
+        std::optional<Result> result;
+        std::optional<ResultAlternate> result_alternate;
+    };
+
+    State* root;
+    std::optional<State> working;
+    // Declared before the path nodes, which decrement it when destroyed.
+    size_t live_snapshots;
+    std::shared_ptr<PathNode> base;
+    std::vector<Step> steps;
+    std::priority_queue<OpenNode, std::vector<OpenNode>, OpenNodeOrder> open;
+    Sink sink;
+    unsigned long incumbents;
+    // Whether the sink holds a solution passed to set_incumbent().
+    bool seeded;
+    Obj primal_bound;
+    size_t max_open;
+    unsigned snapshot_interval;
+    unsigned long nodes;
+    unsigned long transitions;
+    size_t peak_open;
+
+    const std::shared_ptr<PathNode>& current() const {
+        return steps.empty() ? base : steps.back().node;
+    }
+
+    void step_down(const std::shared_ptr<PathNode>& node) {
+        Step step{node, std::nullopt, std::nullopt};
+        if (node->alternate) {
+            step.result_alternate.emplace(working->branch_alternate(*node->rule));
+        } else {
+            step.result.emplace(working->branch(*node->rule));
+        }
+        steps.push_back(std::move(step));
+        transitions++;
+    }
+
+    void step_up() {
+        const Step& step = steps.back();
+        if (step.node->alternate) {
+            working->backtrack(*step.node->rule, *step.result_alternate);
+        } else {
+            working->backtrack(*step.node->rule, *step.result);
+        }
+        steps.pop_back();
+        transitions++;
+    }
+
+    // Transition the working state to the target node.
+    void move_to(const std::shared_ptr<PathNode>& target) {
+        std::vector<std::shared_ptr<PathNode>> chain(target->depth + 1);
+        for (auto p = target; p; p = p->parent) {
+            chain[p->depth] = p;
+        }
+        unsigned snap = target->depth;
+        while (!chain[snap]->snapshot) { --snap; }
+        // Length of the shared prefix of the current and target paths.
+        bool reachable = (base->depth <= target->depth)
+            && (chain[base->depth] == base);
+        unsigned common = base->depth;
+        if (reachable) {
+            while (common - base->depth < steps.size()
+                   && common < target->depth
+                   && steps[common - base->depth].node == chain[common + 1]) {
+                ++common;
+            }
+        }
+        unsigned depth = current()->depth;
+        if (!reachable || (depth - common) + (target->depth - common)
+                > target->depth - snap) {
+            steps.clear();
+            base = chain[snap];
+            working.reset();
+            working.emplace(base->snapshot->state.clone());
+            common = snap;
+        }
+        while (current()->depth > common) { step_up(); }
+        for (unsigned d = common + 1; d <= target->depth; d++) {
+            step_down(chain[d]);
+        }
+        Ensures(current() == target);
+    }
+
+    void record_solution() {
+        Sol solution = working->get_solution();
+        Expects(opt::is_improvement(solution.get_objective_value(), primal_bound));
+        primal_bound = solution.get_objective_value();
+        sink.add(std::move(solution));
+        incumbents++;
+        std::cout << "*  NODES: " << nodes
+                  << "  OPEN: " << open.size()
+                  << "  PRIMAL: " << primal_bound << std::endl;
+    }
+
+    // Evaluate the working state as a child of the current node. Returns
+    // whether it should be added to the open queue.
+    bool evaluate() {
+        nodes++;
+        if (!working->is_feasible() || opt::can_be_pruned(*working, primal_bound)) {
+            return false;
+        }
+        if (working->is_leaf()) {
+            record_solution();
+            return false;
+        }
+        return true;
+    }
+
+    // Evaluate both children of the current node and queue those which
+    // remain open.
+    void expand() {
+        const auto& parent = current();
+        if (snapshot_interval > 0 && parent->depth > 0
+                && (parent->depth % snapshot_interval) == 0 && !parent->snapshot
+                && open.size() + live_snapshots + 3 <= max_open) {
+            parent->snapshot = std::make_unique<Snapshot>(working->clone(), &live_snapshots);
+        }
+        auto [rule, result] = working->branch();
+        bool keep = evaluate();
+        Obj bound = opt::dual_bound(*working);
+        working->backtrack(rule, result);
+        if (keep) {
+            open.push(OpenNode{bound, std::make_shared<PathNode>(
+                PathNode{parent, rule, false, parent->depth + 1, nullptr})});
+        }
+        auto result_alternate = working->branch_alternate(rule);
+        keep = evaluate();
+        bound = opt::dual_bound(*working);
+        working->backtrack(rule, result_alternate);
+        if (keep) {
+            open.push(OpenNode{bound, std::make_shared<PathNode>(
+                PathNode{parent, rule, true, parent->depth + 1, nullptr})});
+        }
+        transitions += 4;
+        peak_open = std::max(peak_open, open.size());
+    }
+
+    // Depth-first search below the working state, as in Solver. The working
+    // state has already been evaluated and is returned to its starting point.
+    void dive() {
+        std::vector<StackElement> stack;
+        stack.emplace_back(working->branch());
+        do {
+            nodes++;
+            if (!working->is_feasible() || opt::can_be_pruned(*working, primal_bound)) {
+                unwind(&stack);
+            } else if (working->is_leaf()) {
+                record_solution();
+                unwind(&stack);
+            } else {
+                stack.emplace_back(working->branch());
+            }
+        } while (stack.size() > 0);
+    }
+
+    void unwind(std::vector<StackElement>* stack) {
+        while ((stack->size() > 0) && stack->back().unwind_step(&*working)) {
+            stack->pop_back();
+        }
+    }
+
+public:
+    BestFirstSolver(State* s, size_t max_open, unsigned snapshot_interval,
+                    Sink k = Sink()) :
+        root(s), working(), live_snapshots(0), base(), steps(), open(), sink(std::move(k)), incumbents(0),
+        seeded(false), primal_bound(initial_primal_bound<Obj, sense>()),
+        max_open(max_open), snapshot_interval(snapshot_interval),
+        nodes(0), transitions(0), peak_open(0) {
+        Expects(max_open > 0);
+    }
+
+    const auto& get_solutions() const { return sink.get_solutions(); }
+    unsigned long get_nodes() const { return nodes; }
+
+    // Start from a known solution, as Solver::set_incumbent.
+    void set_incumbent(Sol solution) {
+        primal_bound = solution.get_objective_value();
+        sink.add(std::move(solution));
+        seeded = true;
+    }
+
+    void solve() {
+        auto start = std::chrono::high_resolution_clock::now();
+        base = std::make_shared<PathNode>(
+            PathNode{nullptr, std::nullopt, false, 0,
+                     std::make_unique<Snapshot>(root->clone(), &live_snapshots)});
+        working.emplace(root->clone());
+        if (evaluate()) {
+            open.push(OpenNode{opt::dual_bound(*working), base});
+        }
+        while (!open.empty()) {
+            OpenNode node = open.top();
+            open.pop();
+            if (!opt::is_improvement(node.bound, primal_bound)) {
+                // Every remaining node is bounded at least as badly.
+                break;
+            }
+            move_to(node.node);
+            if (open.size() + live_snapshots + 2 > max_open) {
+                dive();
+            } else {
+                expand();
+            }
+        }
+        double runtime = std::chrono::duration<double, std::milli>
+            (std::chrono::high_resolution_clock::now() - start)
+            .count() / 1000;
+        std::cout << "====== COMPLETE ======" << std::endl;
+        std::cout << "Status:      Optimal" << std::endl;
+        std::cout << "Nodes:       " << nodes << std::endl;
+        std::cout << "Transitions: " << transitions << std::endl;
+        std::cout << "Peak Open:   " << peak_open << std::endl;
+        std::cout << "Solutions:   " << incumbents << std::endl;
+        std::cout << "Time:        " << runtime << " seconds" << std::endl;
+        std::cout << "Objective:   ";
+        if (incumbents > 0 || seeded) { std::cout << primal_bound; } else { std::cout << "none"; }
+        std::cout << std::endl;
+        std::cout << "Rate:        " << nodes / runtime << " nodes/second" << std::endl;
+        std::cout << "======================" << std::endl;
+    }
+};
+
+#endif  // SRC_ARBORY_BESTFIRST_HPP_
@@ -0,0 +1,116 @@
+#ifndef SRC_ARBORY_CHECKPOINT_HPP_
+#define SRC_ARBORY_CHECKPOINT_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+
+// Where and how often a search saves its progress. The file is replaced
+// atomically (write then rename), so a preempted run leaves either the old
+// or the new checkpoint behind.
+struct CheckpointOptions {
+    std::string file;               // Empty: no checkpointing.
+    double interval = 60.0;         // Seconds between checkpoints.
+};
+
+
+// Saved progress of a depth-first search. Paths are strings of '0' (main
+// branch, alternate still open) and '1' (alternate branch) from the root, as
+// in decomposition.hpp; since branch() is deterministic the path is enough to
+// rebuild the stack on a fresh root. The best solution is saved as the path
+// to its leaf, so solution types need no serialisation.
+//
+// File layout (native byte order): magic, version, complete flag, nodes,
+// primal bound, incumbent flag and path, current path. Paths are written as
+// a bit count followed by the bits packed 8 to a byte.
+template <typename Obj>
+struct Checkpoint {
+    static_assert(std::is_trivially_copyable_v<Obj>);
+    static constexpr uint32_t magic = 0x43524241;   // "ABRC"
+    static constexpr uint32_t version = 1;
+
+    bool complete = false;          // Search finished: nothing left to explore.
+    uint64_t nodes = 0;
+    Obj primal_bound;
+    std::optional<std::string> incumbent;
+    std::string path;
+
+    void write(const std::string& file_name) const {
+        std::string temp_name = file_name + ".tmp";
+        {
+            std::ofstream out(temp_name, std::ios::binary | std::ios::trunc);
+            write_raw(out, magic);
+            write_raw(out, version);
+            write_raw(out, static_cast<uint8_t>(complete));
+            write_raw(out, nodes);
+            write_raw(out, primal_bound);
+            write_raw(out, static_cast<uint8_t>(incumbent.has_value()));
+            if (incumbent) { write_path(out, *incumbent); }
+            write_path(out, path);
+            if (!out) { throw std::runtime_error("Failed to write checkpoint."); }
+        }
+        if (std::rename(temp_name.c_str(), file_name.c_str()) != 0) {
+            throw std::runtime_error("Failed to replace checkpoint.");
+        }
+    }
+
+    // Returns nothing if the file does not exist.
+    static std::optional<Checkpoint> read(const std::string& file_name) {
+        std::ifstream in(file_name, std::ios::binary);
+        if (!in.is_open()) { return std::nullopt; }
+        Checkpoint checkpoint;
+        if (read_raw<uint32_t>(in) != magic || read_raw<uint32_t>(in) != version) {
+            throw std::domain_error("Not a checkpoint file (or wrong version).");
+        }
+        checkpoint.complete = read_raw<uint8_t>(in);
+        checkpoint.nodes = read_raw<uint64_t>(in);
+        checkpoint.primal_bound = read_raw<Obj>(in);
+        if (read_raw<uint8_t>(in)) { checkpoint.incumbent = read_path(in); }
+        checkpoint.path = read_path(in);
+        if (!in) { throw std::domain_error("Truncated checkpoint file."); }
+        return checkpoint;
+    }
+
+private:
+    template <typename T>
+    static void write_raw(std::ostream& out, const T& value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    static T read_raw(std::istream& in) {
+        T value{};
+        in.read(reinterpret_cast<char*>(&value), sizeof(T));
+        return value;
+    }
+
+    static void write_path(std::ostream& out, const std::string& path) {
+        write_raw(out, static_cast<uint32_t>(path.size()));
+        for (size_t i = 0; i < path.size(); i += 8) {
+            uint8_t byte = 0;
+            for (size_t j = i; j < std::min(i + 8, path.size()); j++) {
+                byte |= (path[j] == '1') << (j - i);
+            }
+            write_raw(out, byte);
+        }
+    }
+
+    static std::string read_path(std::istream& in) {
+        std::string path(read_raw<uint32_t>(in), '0');
+        for (size_t i = 0; i < path.size() && in; i += 8) {
+            uint8_t byte = read_raw<uint8_t>(in);
+            for (size_t j = i; j < std::min(i + 8, path.size()); j++) {
+                if (byte & (1 << (j - i))) { path[j] = '1'; }
+            }
+        }
+        return path;
+    }
+};
+
+#endif  // SRC_ARBORY_CHECKPOINT_HPP_
@@ -0,0 +1,48 @@
+#ifndef SRC_ARBORY_COORDINATOR_HPP_
+#define SRC_ARBORY_COORDINATOR_HPP_
+
+#include <atomic>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "limits.hpp"
+#include "sense.hpp"
+
+
+// Solves a set of subproblems (prefixes, see decomposition.hpp) by running
+// each in a child process, at most `processes` at a time. Children are given
+// the best objective found so far as their starting primal bound and write a
+// JSON report (see statistics.hpp), which is read back on exit. Subproblems
+// which stop before being solved (e.g. on a time limit) are split into their
+// two child prefixes and queued again, so long-running subtrees are spread
+// over the free processes.
+//
+// The command callback returns the argv for a child solving the prefix with
+// the given starting bound (if any) and writing its report to the given file.
+// The child's stdout is captured; the output of the child which found the
+// best solution is returned so the caller can recover the solution itself.
+using SubproblemCommand = std::function<std::vector<std::string>(
+    const std::string& prefix, std::optional<double> primal_bound,
+    const std::string& report)>;
+
+
+struct CoordinatorResult {
+    Status status;                      // Optimal once every subproblem is solved.
+    std::optional<double> objective;    // Best objective over all subproblems.
+    std::string best_prefix;
+    std::string best_output;            // Captured stdout of the best child.
+    unsigned long subproblems;          // Child processes run.
+    unsigned long resplits;             // Unfinished subproblems split again.
+    double time;
+};
+
+
+CoordinatorResult coordinate_subproblems(
+    const std::vector<std::string>& prefixes, const SubproblemCommand& command,
+    unsigned processes, Sense sense, std::ostream& log = std::cout,
+    const std::atomic<bool>* interrupt = nullptr);
+
+#endif  // SRC_ARBORY_COORDINATOR_HPP_
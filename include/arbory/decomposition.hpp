@@ -0,0 +1,84 @@
+#ifndef SRC_ARBORY_DECOMPOSITION_HPP_
+#define SRC_ARBORY_DECOMPOSITION_HPP_
+
+#include <deque>
+#include <string>
+#include <vector>
+#include <gsl/gsl_assert>
+
+#include "backtracking.hpp"
+
+
+// Subtrees of the search tree are identified by the branch decisions leading
+// to them from the root, written as a string with '0' for the main branch
+// and '1' for the alternate branch at each level. The empty prefix is the
+// whole tree. Since branch() is deterministic given the path to a node (see
+// api.md) a prefix is enough to rebuild the subtree root in another process.
+
+
+// Applies the transitions of a prefix to a state and reverts them.
+template <typename State>
+class PrefixPath {
+    using StackElement = typename SearchTypes<State>::StackElement;
+
+    State* state;
+    std::vector<StackElement> stack;
+
+public:
+    explicit PrefixPath(State* s) : state(s), stack() {}
+    ~PrefixPath() { revert(); }
+
+    // Replay the prefix from the current state. Returns false (leaving the
+    // state unchanged) if the path runs through an infeasible node or a
+    // leaf, in which case the subtree does not exist.
+    bool apply(const std::string& prefix) {
+        Expects(stack.empty());
+        for (char c : prefix) {
+            Expects(c == '0' || c == '1');
+            if (!state->is_feasible() || state->is_leaf()) {
+                revert();
+                return false;
+            }
+            stack.emplace_back(state->branch());
+            if (c == '1') {
+                bool popped = stack.back().unwind_step(state);
+                Ensures(!popped);
+            }
+        }
+        return true;
+    }
+
+    void revert() {
+        while (stack.size() > 0) {
+            stack.back().backtrack(state);
+            stack.pop_back();
+        }
+    }
+};
+
+
+// Split the tree below the state into at least n (if possible) disjoint
+// subtrees which together cover every solution, by expanding the shallowest
+// open prefix first. Infeasible subtrees are dropped and leaves are kept as
+// (trivial) subproblems, so no bound is needed and no solution is lost.
+template <typename State>
+std::vector<std::string> split_prefixes(State* state, unsigned n) {
+    std::vector<std::string> done;
+    std::deque<std::string> open = {""};
+    while (!open.empty() && (done.size() + open.size() < n)) {
+        std::string prefix = open.front();
+        open.pop_front();
+        PrefixPath<State> path(state);
+        if (!path.apply(prefix) || !state->is_feasible()) { continue; }
+        if (state->is_leaf()) {
+            done.push_back(prefix);
+        } else {
+            open.push_back(prefix + "0");
+            open.push_back(prefix + "1");
+        }
+    }
+    done.insert(done.end(), open.begin(), open.end());
+    return done;
+}
+
+#endif  // SRC_ARBORY_DECOMPOSITION_HPP_
@@ -0,0 +1,66 @@
+#ifndef SRC_ARBORY_LIMITS_HPP_
+#define SRC_ARBORY_LIMITS_HPP_
+
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <optional>
+
+
+// Reason a search stopped. Anything other than Optimal means the dual bound
+// reported with the result may still be better than the best solution.
+enum class Status {
+    Optimal, TimeLimit, NodeLimit, GapLimit, Interrupted
+};
+
+
+inline const char* status_name(Status status) {
+    switch (status) {
+        case Status::Optimal: return "Optimal";
+        case Status::TimeLimit: return "TimeLimit";
+        case Status::NodeLimit: return "NodeLimit";
+        case Status::GapLimit: return "GapLimit";
+        case Status::Interrupted: return "Interrupted";
+    }
+    return "Unknown";
+}
+
+
+// Termination criteria for a search. The defaults never stop early.
+// Gaps are between the incumbent and the global dual bound; the relative
+// gap is taken against the magnitude of the incumbent. If set, the search
+// stops once *interrupt becomes true (e.g. from a signal handler).
+struct SearchLimits {
+    double time = std::numeric_limits<double>::infinity();
+    unsigned long nodes = std::numeric_limits<unsigned long>::max();
+    double absolute_gap = 0.0;
+    double relative_gap = 0.0;
+    const std::atomic<bool>* interrupt = nullptr;
+
+    bool interrupted() const {
+        return (interrupt != nullptr) && interrupt->load(std::memory_order_relaxed);
+    }
+
+    template <typename Obj>
+    bool gap_reached(const Obj& primal_bound, const Obj& dual_bound) const {
+        double gap = std::abs(
+            static_cast<double>(dual_bound) - static_cast<double>(primal_bound));
+        return (gap <= absolute_gap)
+            || (gap <= relative_gap * std::abs(static_cast<double>(primal_bound)));
+    }
+};
+
+
+// Outcome of a search: why it stopped, the best solution found (if any) and
+// the bounds proven on the optimal objective value.
+template <typename Sol, typename Obj>
+struct SolveResult {
+    Status status;
+    std::optional<Sol> solution;
+    Obj primal_bound;
+    Obj dual_bound;
+    unsigned long nodes;
+    double time;
+};
+
+#endif  // SRC_ARBORY_LIMITS_HPP_
@@ -0,0 +1,161 @@
+#ifndef SRC_ARBORY_MICROBENCH_HPP_
+#define SRC_ARBORY_MICROBENCH_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "backtracking.hpp"
+#include "decomposition.hpp"
+#include "sense.hpp"
+
+
+// Harness for timing individual state primitives (branch, backtrack, bound
+// and graph queries) on states sampled from real search trees.
+//
+// Allocations are counted by replacing global operator new, which must be
+// done in exactly one translation unit: define ARBORY_MICROBENCH_MAIN before
+// including this header in the microbenchmark's main file.
+
+
+inline std::atomic<unsigned long>& allocation_count() {
+    static std::atomic<unsigned long> count(0);
+    return count;
+}
+
+
+#ifdef ARBORY_MICROBENCH_MAIN
+void* operator new(std::size_t size) {
+    allocation_count().fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) { return p; }
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+#endif
+
+
+// Decision paths (see decomposition.hpp) of count nodes chosen uniformly
+// (reservoir sampling) from the first max_nodes nodes visited by a
+// depth-first search with pruning, so samples follow the distribution of
+// states the solver actually visits.
+template <typename State, Sense sense>
+std::vector<std::string> sample_paths(
+        State* state, size_t count, unsigned long max_nodes, unsigned seed = 0) {
+    using opt = SenseOps<sense>;
+    using Obj = typename SearchTypes<State>::Obj;
+    using StackElement = typename SearchTypes<State>::StackElement;
+    std::vector<std::string> paths;
+    std::vector<StackElement> stack;
+    Obj primal_bound = initial_primal_bound<Obj, sense>();
+    std::mt19937_64 rng(seed);
+    unsigned long nodes = 0;
+    do {
+        bool prune = !state->is_feasible() || opt::can_be_pruned(*state, primal_bound);
+        if (!prune) {
+            size_t slot = (nodes < count) ? nodes : rng() % (nodes + 1);
+            if (slot < count) {
+                std::string path(stack.size(), '0');
+                for (size_t i = 0; i < stack.size(); i++) {
+                    if (stack[i].alternate_evaluated()) { path[i] = '1'; }
+                }
+                if (slot < paths.size()) {
+                    paths[slot] = std::move(path);
+                } else {
+                    paths.push_back(std::move(path));
+                }
+            }
+            nodes++;
+        }
+        if (prune || state->is_leaf()) {
+            if (!prune) { primal_bound = state->get_solution().get_objective_value(); }
+            while ((stack.size() > 0) && stack.back().unwind_step(state)) {
+                stack.pop_back();
+            }
+        } else {
+            stack.emplace_back(state->branch());
+        }
+    } while (stack.size() > 0 && nodes < max_nodes);
+    while (stack.size() > 0) {
+        stack.back().backtrack(state);
+        stack.pop_back();
+    }
+    return paths;
+}
+
+
+// Independent copies of the states at each path below the root.
+template <typename State>
+std::vector<State> sample_states(State* root, const std::vector<std::string>& paths) {
+    std::vector<State> states;
+    states.reserve(paths.size());
+    for (const auto& path : paths) {
+        PrefixPath<State> prefix(root);
+        bool found = prefix.apply(path);
+        Ensures(found);
+        states.push_back(root->clone());
+    }
+    return states;
+}
+
+
+struct MicrobenchResult {
+    std::string name;
+    unsigned long ops;
+    double ns_per_op;
+    double allocs_per_op;
+};
+
+
+// Apply op to each item in turn, in rounds, until min_time seconds have
+// passed. Each call counts as one operation; ops which change an item must
+// restore it (e.g. branch then backtrack). An untimed warm-up round first
+// lets containers in the items reach their working capacity.
+template <typename Item, typename Op>
+MicrobenchResult measure(
+        const std::string& name, std::vector<Item>& items, Op op,
+        double min_time = 0.2) {
+    Expects(!items.empty());
+    using clock = std::chrono::steady_clock;
+    for (auto& item : items) { op(item); }
+    unsigned long ops = 0;
+    unsigned long allocations = allocation_count().load(std::memory_order_relaxed);
+    auto start = clock::now();
+    std::chrono::duration<double> elapsed(0);
+    while (elapsed.count() < min_time) {
+        for (auto& item : items) { op(item); }
+        ops += items.size();
+        elapsed = clock::now() - start;
+    }
+    allocations = allocation_count().load(std::memory_order_relaxed) - allocations;
+    return MicrobenchResult{
+        name, ops, elapsed.count() * 1e9 / ops,
+        static_cast<double>(allocations) / ops};
+}
+
+
+inline void print_results(
+        const std::string& title, const std::vector<MicrobenchResult>& results,
+        std::ostream& out = std::cout) {
+    out << "====== " << title << " ======" << std::endl;
+    out << std::left << std::setw(32) << "primitive"
+        << std::right << std::setw(12) << "ns/op"
+        << std::setw(14) << "allocs/op"
+        << std::setw(14) << "ops" << std::endl;
+    for (const auto& result : results) {
+        out << std::left << std::setw(32) << result.name
+            << std::right << std::fixed << std::setprecision(1)
+            << std::setw(12) << result.ns_per_op
+            << std::setprecision(3) << std::setw(14) << result.allocs_per_op
+            << std::setw(14) << result.ops << std::endl;
+    }
+    out.unsetf(std::ios::fixed);
+}
+
+#endif  // SRC_ARBORY_MICROBENCH_HPP_
@@ -0,0 +1,158 @@
+#ifndef SRC_ARBORY_MONITOR_HPP_
+#define SRC_ARBORY_MONITOR_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "statistics.hpp"
+
+
+// Counters published by a search thread with relaxed stores, for a monitor
+// thread to sample. Only the search thread writes to them.
+template <typename Obj>
+struct SearchProgress {
+    std::atomic<unsigned long> nodes;
+    std::atomic<unsigned long> incumbents;
+    std::atomic<Obj> primal_bound;
+    std::atomic<unsigned> depth;
+    std::atomic<unsigned> ldepth;       // Depth of the fully-explored prefix.
+
+    explicit SearchProgress(Obj initial) :
+        nodes(0), incumbents(0), primal_bound(initial), depth(0), ldepth(0) {}
+
+    void reset(Obj initial) {
+        nodes.store(0, std::memory_order_relaxed);
+        incumbents.store(0, std::memory_order_relaxed);
+        primal_bound.store(initial, std::memory_order_relaxed);
+        depth.store(0, std::memory_order_relaxed);
+        ldepth.store(0, std::memory_order_relaxed);
+    }
+};
+
+
+// Flag raised (e.g. by a signal handler) to have running monitors write a
+// snapshot line as soon as they next wake.
+inline std::atomic<bool>& snapshot_requested() {
+    static std::atomic<bool> flag(false);
+    return flag;
+}
+
+
+inline void request_snapshot(int) {
+    snapshot_requested().store(true, std::memory_order_relaxed);
+}
+
+
+// Write a snapshot from every running monitor on receipt of the signal.
+inline void install_snapshot_signal(int signal_number = SIGUSR1) {
+    snapshot_requested();
+    std::signal(signal_number, request_snapshot);
+}
+
+
+// Thread which samples a search's published counters and does all of its
+// progress logging, so the search loop never waits on the clock or on I/O.
+// Lines are written every log.interval seconds (if positive), whenever the
+// incumbent count changes, and on a snapshot request.
+template <typename Obj>
+class ProgressMonitor {
+    using Sample = typename SearchStatistics<Obj>::Sample;
+    static constexpr double tick = 0.05;
+
+    const SearchProgress<Obj>& progress;
+    const LogOptions& log;
+    std::chrono::time_point<std::chrono::high_resolution_clock> start;
+    std::vector<Sample> samples;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stopping;
+    std::thread thread;
+
+    double elapsed() const {
+        return std::chrono::duration<double>(
+            std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    void write(const char* event, double runtime, unsigned long nodes) {
+        std::ostream& out = *log.stream;
+        Obj primal_bound = progress.primal_bound.load(std::memory_order_relaxed);
+        unsigned depth = progress.depth.load(std::memory_order_relaxed);
+        unsigned ldepth = progress.ldepth.load(std::memory_order_relaxed);
+        if (log.format == LogFormat::JSON) {
+            out << "{\"event\": \"" << event << "\""
+                << ", \"time\": " << runtime
+                << ", \"nodes\": " << nodes
+                << ", \"primal\": " << primal_bound
+                << ", \"depth\": " << depth
+                << ", \"ldepth\": " << ldepth
+                << "}" << std::endl;
+        } else {
+            out << ((event[0] == 'i') ? "*" : " ")
+                << "  TIME: " << runtime << "s"
+                << "  NODES: " << nodes
+                << "  PRIMAL: " << primal_bound
+                << "  DEPTH: " << depth
+                << "  LDEPTH: " << ldepth
+                << std::endl;
+        }
+    }
+
+    void run() {
+        double next_report = log.interval;
+        unsigned long incumbents = 0;
+        auto wait = std::chrono::duration<double>(
+            (log.interval > 0) ? std::min(log.interval, tick) : tick);
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!cv.wait_for(lock, wait, [this] { return stopping; })) {
+            double runtime = elapsed();
+            unsigned long nodes = progress.nodes.load(std::memory_order_relaxed);
+            unsigned long found = progress.incumbents.load(std::memory_order_relaxed);
+            if (found != incumbents) {
+                incumbents = found;
+                write("incumbent", runtime, nodes);
+            }
+            if (snapshot_requested().exchange(false, std::memory_order_relaxed)) {
+                write("snapshot", runtime, nodes);
+            }
+            if (log.interval > 0 && runtime >= next_report) {
+                samples.push_back({runtime, nodes});
+                write("progress", runtime, nodes);
+                next_report = runtime + log.interval;
+            }
+        }
+        if (progress.incumbents.load(std::memory_order_relaxed) != incumbents) {
+            write("incumbent", elapsed(), progress.nodes.load(std::memory_order_relaxed));
+        }
+    }
+
+public:
+    ProgressMonitor(
+            const SearchProgress<Obj>& p, const LogOptions& l,
+            std::chrono::time_point<std::chrono::high_resolution_clock> s) :
+        progress(p), log(l), start(s), samples(), stopping(false),
+        thread(&ProgressMonitor::run, this) {}
+
+    ~ProgressMonitor() { stop(); }
+
+    // Stop and join the monitor thread, returning the rate samples taken.
+    std::vector<Sample> stop() {
+        if (thread.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            cv.notify_one();
+            thread.join();
+        }
+        return std::move(samples);
+    }
+};
+
+#endif  // SRC_ARBORY_MONITOR_HPP_
@@ -0,0 +1,240 @@
+#ifndef SRC_ARBORY_PARALLEL_HPP_
+#define SRC_ARBORY_PARALLEL_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <gsl/gsl_assert>
+
+#include "backtracking.hpp"
+#include "sense.hpp"
+#include "sinks.hpp"
+
+
+// Multi-threaded depth-first search using work stealing.
+//
+// Each worker owns a clone of the state and its own stack and runs the same
+// loop as Solver. Idle workers register as hungry; busy workers check for
+// hunger once per node and donate the alternate branch of the bottom-most
+// open node of their stack (the largest unexplored subtree they hold).
+// Workers stay hungry until they take a package, and donations are only
+// made while hungry workers outnumber the packages queued or being made,
+// so a package taken by a worker that finds one on arrival leaves its
+// waiter counted, and another donation is made for it.
+//
+// A donation is a clone of the donor's current state plus a copy of the stack
+// nodes from the donated node to the top. The thief unwinds the copy back to
+// the donated node and takes its alternate branch, so the donor never pays
+// for anything more than a clone. The primal bound is shared atomically so
+// all workers prune against the best incumbent found by any of them.
+//
+// Required methods (in addition to those used by Solver):
+//
+//      State:
+//          State clone() const
+//
+template <typename State, Sense sense,
+          typename Sink = KeepBest<typename SearchTypes<State>::Sol>>
+class ParallelSolver {
+    using opt = SenseOps<sense>;
+    using Sol = typename SearchTypes<State>::Sol;
+    using Obj = typename SearchTypes<State>::Obj;
+    using StackElement = typename SearchTypes<State>::StackElement;
+
+    // A subtree handed to an idle worker. With an empty stack the state
+    // itself is the subtree root.
+    struct WorkPackage {
+        State state;
+        std::vector<StackElement> stack;
+    };
+
+    State* root;
+    unsigned threads;
+    std::atomic<Obj> primal_bound;
+    std::atomic<unsigned> hungry;
+    std::atomic<unsigned long> nodes;
+    std::atomic<unsigned long> steals;
+
+    // Guarded by queue_mutex.
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;
+    std::deque<WorkPackage> packages;
+    // Donations counted but not yet queued.
+    unsigned donating;
+    unsigned idle;
+    bool done;
+
+    // Guarded by solution_mutex.
+    std::mutex solution_mutex;
+    Sink sink;
+    unsigned long incumbents;
+    // Whether the sink holds a solution passed to set_incumbent().
+    bool seeded;
+    std::chrono::time_point<std::chrono::high_resolution_clock> start;
+
+    // Block until a package is available, or return false if all workers
+    // are idle and there is no work left anywhere.
+    bool acquire(std::optional<WorkPackage>* work) {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        if (packages.empty()) {
+            ++idle;
+            if (idle == threads) {
+                done = true;
+                queue_cv.notify_all();
+                return false;
+            }
+            hungry.fetch_add(1, std::memory_order_relaxed);
+            queue_cv.wait(lock, [this] { return done || !packages.empty(); });
+            if (done) { return false; }
+            hungry.fetch_sub(1, std::memory_order_relaxed);
+            --idle;
+        }
+        work->emplace(std::move(packages.front()));
+        packages.pop_front();
+        return true;
+    }
+
+    // Give the alternate branch of the lowest open stack node to a hungry
+    // worker. Nodes below *cursor are known to be closed.
+    void donate(const State& state, std::vector<StackElement>* stack, size_t* cursor) {
+        while (*cursor < stack->size() && !(*stack)[*cursor].is_open()) {
+            ++*cursor;
+        }
+        if (*cursor == stack->size()) { return; }
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            if (hungry.load(std::memory_order_relaxed) <= packages.size() + donating) { return; }
+            ++donating;
+        }
+        WorkPackage package{state.clone(), std::vector<StackElement>(
+            stack->begin() + *cursor, stack->end())};
+        (*stack)[*cursor].donate();
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            packages.push_back(std::move(package));
+            --donating;
+        }
+        steals.fetch_add(1, std::memory_order_relaxed);
+        queue_cv.notify_one();
+    }
+
+    void record_solution(const State& state) {
+        Sol solution = state.get_solution();
+        std::lock_guard<std::mutex> lock(solution_mutex);
+        if (opt::is_improvement(solution.get_objective_value(),
+                                primal_bound.load(std::memory_order_relaxed))) {
+            primal_bound.store(solution.get_objective_value(), std::memory_order_relaxed);
+            sink.add(std::move(solution));
+            incumbents++;
+            double runtime = std::chrono::duration<double>(
+                std::chrono::high_resolution_clock::now() - start).count();
+            std::cout << "*  TIME: " << runtime << "s"
+                      << "  NODES: " << nodes.load(std::memory_order_relaxed)
+                      << "  PRIMAL: " << primal_bound.load(std::memory_order_relaxed)
+                      << std::endl;
+        }
+    }
+
+    // Depth-first search of the subtree given by a work package.
+    void search(WorkPackage* work) {
+        State* state = &work->state;
+        if (!work->stack.empty()) {
+            // Unwind the donor's stack copy and take the donated branch.
+            for (auto it = work->stack.rbegin(); it + 1 != work->stack.rend(); ++it) {
+                it->backtrack(state);
+            }
+            bool popped = work->stack.front().unwind_step(state);
+            Ensures(!popped);
+            work->stack.clear();
+        }
+        std::vector<StackElement> stack;
+        size_t cursor = 0;
+        unsigned long local_nodes = 0;
+        do {
+            if (!state->is_feasible() || opt::can_be_pruned(
+                    *state, primal_bound.load(std::memory_order_relaxed))) {
+                unwind_and_branch_alternate(state, &stack, &cursor);
+            } else if (state->is_leaf()) {
+                record_solution(*state);
+                unwind_and_branch_alternate(state, &stack, &cursor);
+            } else {
+                stack.emplace_back(state->branch());
+            }
+            local_nodes++;
+            if (hungry.load(std::memory_order_relaxed) > 0) {
+                donate(*state, &stack, &cursor);
+            }
+            // Publish in batches to avoid contention on the counter.
+            if ((local_nodes & 0x3FF) == 0) {
+                nodes.fetch_add(0x400, std::memory_order_relaxed);
+            }
+        } while (stack.size() > 0);
+        nodes.fetch_add(local_nodes & 0x3FF, std::memory_order_relaxed);
+    }
+
+    static void unwind_and_branch_alternate(
+            State* state, std::vector<StackElement>* stack, size_t* cursor) {
+        while ((stack->size() > 0) && stack->back().unwind_step(state)) {
+            stack->pop_back();
+        }
+        if (*cursor > stack->size()) { *cursor = stack->size(); }
+    }
+
+    void worker() {
+        std::optional<WorkPackage> work;
+        while (acquire(&work)) {
+            search(&*work);
+            work.reset();
+        }
+    }
+
+public:
+    ParallelSolver(State* s, unsigned t, Sink k = Sink()) :
+        root(s), threads(t), primal_bound(initial_primal_bound<Obj, sense>()),
+        hungry(0), nodes(0), steals(0), donating(0), idle(0), done(false),
+        sink(std::move(k)), incumbents(0), seeded(false) {
+        Expects(threads > 0);
+    }
+
+    const auto& get_solutions() const { return sink.get_solutions(); }
+
+    // Start from a known solution, as Solver::set_incumbent.
+    void set_incumbent(Sol solution) {
+        primal_bound.store(solution.get_objective_value(), std::memory_order_relaxed);
+        sink.add(std::move(solution));
+        seeded = true;
+    }
+
+    void solve() {
+        start = std::chrono::high_resolution_clock::now();
+        packages.push_back(WorkPackage{root->clone(), {}});
+        std::vector<std::thread> workers;
+        for (unsigned i = 0; i < threads; i++) {
+            workers.emplace_back(&ParallelSolver::worker, this);
+        }
+        for (auto& w : workers) { w.join(); }
+        double runtime = std::chrono::duration<double>(
+            std::chrono::high_resolution_clock::now() - start).count();
+        std::cout << "====== COMPLETE ======" << std::endl;
+        std::cout << "Status:      Optimal" << std::endl;
+        std::cout << "Threads:     " << threads << std::endl;
+        std::cout << "Nodes:       " << nodes << std::endl;
+        std::cout << "Steals:      " << steals << std::endl;
+        std::cout << "Solutions:   " << incumbents << std::endl;
+        std::cout << "Time:        " << runtime << " seconds" << std::endl;
+        std::cout << "Objective:   ";
+        if (incumbents > 0 || seeded) { std::cout << primal_bound; } else { std::cout << "none"; }
+        std::cout << std::endl;
+        std::cout << "Rate:        " << nodes / runtime << " nodes/second" << std::endl;
+        std::cout << "======================" << std::endl;
+    }
+};
+
+#endif  // SRC_ARBORY_PARALLEL_HPP_
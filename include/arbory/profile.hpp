@@ -0,0 +1,226 @@
+#ifndef SRC_ARBORY_PROFILE_HPP_
+#define SRC_ARBORY_PROFILE_HPP_
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <utility>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+// Optional per-phase instrumentation of the search loop (see Solver). The
+// default NoProfiler compiles away; PerfProfiler reads Linux hardware
+// counters around each phase so their cost can be attributed without an
+// external profiler.
+//
+// Required methods:
+//
+//      Profiler:
+//          static constexpr bool enabled
+//          void start()                    // On the search thread.
+//          void begin()
+//          void end(Phase phase)
+//          void write_json(std::ostream& out, unsigned long nodes) const
+//          void write_text(std::ostream& out, unsigned long nodes) const
+
+
+enum class Phase {
+    Bound,          // Feasibility, bound and leaf checks.
+    Branch,         // branch() to a child.
+    Backtrack,      // Unwinding, including the alternate branch.
+    Leaf            // Extracting and storing a solution.
+};
+
+constexpr size_t phase_count = 4;
+
+inline const char* phase_name(size_t phase) {
+    constexpr const char* names[phase_count] = {"bound", "branch", "backtrack", "leaf"};
+    return names[phase];
+}
+
+
+struct NoProfiler {
+    static constexpr bool enabled = false;
+    void start() {}
+    void begin() {}
+    void end(Phase) {}
+    void write_json(std::ostream&, unsigned long) const {}
+    void write_text(std::ostream&, unsigned long) const {}
+};
+
+
+// Counters for the calling thread, in user space only, read as one group
+// so they are scheduled together. Counters the machine (or a container's
+// perf_event_paranoid setting) does not allow are left out individually.
+class PerfCounters {
+public:
+    static constexpr size_t count = 5;
+    using Values = std::array<uint64_t, count>;
+
+    static const char* name(size_t i) {
+        constexpr const char* names[count] = {
+            "task_clock_ns", "cycles", "instructions", "cache_misses", "branch_misses"};
+        return names[i];
+    }
+
+private:
+    int leader = -1;
+    std::array<int, count> fds;
+    // Position of each counter in the group read (-1 if not open).
+    std::array<int, count> slot;
+    int members = 0;
+
+public:
+    PerfCounters() { fds.fill(-1); slot.fill(-1); }
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+    ~PerfCounters() { close(); }
+
+    bool is_open(size_t i) const { return slot[i] >= 0; }
+    bool available() const { return members > 0; }
+
+    void open() {
+#ifdef __linux__
+        close();
+        constexpr std::array<std::pair<uint32_t, uint64_t>, count> events = {{
+            {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES}}};
+        for (size_t i = 0; i < count; i++) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = events[i].first;
+            attr.config = events[i].second;
+            attr.read_format = PERF_FORMAT_GROUP;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.disabled = (leader < 0);
+            int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0));
+            if (fd < 0) { continue; }
+            if (leader < 0) { leader = fd; }
+            fds[i] = fd;
+            slot[i] = members++;
+        }
+        if (leader >= 0) {
+            ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+#endif
+    }
+
+    void close() {
+#ifdef __linux__
+        for (auto& fd : fds) {
+            if (fd >= 0) { ::close(fd); }
+            fd = -1;
+        }
+#endif
+        leader = -1;
+        slot.fill(-1);
+        members = 0;
+    }
+
+    Values read() const {
+        Values values{};
+#ifdef __linux__
+        if (leader < 0) { return values; }
+        uint64_t buffer[count + 1];
+        if (::read(leader, buffer, sizeof(buffer)) > 0) {
+            for (size_t i = 0; i < count; i++) {
+                if (slot[i] >= 0) { values[i] = buffer[1 + slot[i]]; }
+            }
+        }
+#endif
+        return values;
+    }
+};
+
+
+// Accumulates counter deltas over each phase. Every begin/end pair costs a
+// read() system call (~1us), which dwarfs a typical node, so node rates
+// reported alongside a profile are not representative; the counters
+// themselves exclude kernel time.
+class PerfProfiler {
+    using Values = PerfCounters::Values;
+
+    PerfCounters counters;
+    std::array<Values, phase_count> totals{};
+    std::array<unsigned long, phase_count> calls{};
+    Values mark{};
+
+public:
+    static constexpr bool enabled = true;
+
+    void start() {
+        counters.open();
+        totals = {};
+        calls = {};
+    }
+
+    void begin() { mark = counters.read(); }
+
+    void end(Phase phase) {
+        Values now = counters.read();
+        auto& total = totals[static_cast<size_t>(phase)];
+        for (size_t i = 0; i < PerfCounters::count; i++) {
+            total[i] += now[i] - mark[i];
+        }
+        calls[static_cast<size_t>(phase)]++;
+    }
+
+    // Per-node averages of each counter by phase.
+    void write_json(std::ostream& out, unsigned long nodes) const {
+        out << "{\"available\": " << (counters.available() ? "true" : "false");
+        for (size_t p = 0; p < phase_count; p++) {
+            out << ", \"" << phase_name(p) << "\": {\"calls\": " << calls[p];
+            for (size_t i = 0; i < PerfCounters::count; i++) {
+                out << ", \"" << PerfCounters::name(i) << "_per_node\": ";
+                if (counters.is_open(i) && nodes > 0) {
+                    out << static_cast<double>(totals[p][i]) / nodes;
+                } else {
+                    out << "null";
+                }
+            }
+            out << "}";
+        }
+        out << "}";
+    }
+
+    void write_text(std::ostream& out, unsigned long nodes) const {
+        out << "====== PROFILE (per node) ======" << std::endl;
+        if (!counters.available()) {
+            out << "perf_event_open unavailable (see perf_event_paranoid)" << std::endl;
+            return;
+        }
+        out << std::left << std::setw(12) << "phase";
+        for (size_t i = 0; i < PerfCounters::count; i++) {
+            if (counters.is_open(i)) {
+                out << std::right << std::setw(16) << PerfCounters::name(i);
+            }
+        }
+        out << std::endl;
+        for (size_t p = 0; p < phase_count; p++) {
+            out << std::left << std::setw(12) << phase_name(p);
+            for (size_t i = 0; i < PerfCounters::count; i++) {
+                if (counters.is_open(i)) {
+                    out << std::right << std::setw(16)
+                        << ((nodes > 0) ? static_cast<double>(totals[p][i]) / nodes : 0.0);
+                }
+            }
+            out << std::endl;
+        }
+    }
+};
+
+#endif  // SRC_ARBORY_PROFILE_HPP_
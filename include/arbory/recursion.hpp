@@ -1,8 +1,11 @@
 #ifndef SRC_RECURSION_HPP
 #define SRC_RECURSION_HPP
 
+#include <atomic>
+#include <future>
 #include <optional>
 #include <type_traits>
+#include <utility>
 #include <gsl/gsl_assert>
 
 #include "sense.hpp"
@@ -69,4 +72,127 @@ auto solve_recursive(State* state) {
         state, initial_primal_bound<Obj, sense>());
 }
 
+// Start from a known solution (e.g. found by a heuristic): returns a better
+// one if there is one, otherwise the incumbent.
+template <typename State, Sense sense, typename Sol>
+std::optional<Sol> solve_recursive(State* state, Sol incumbent) {
+    using Obj = typename std::invoke_result<decltype(&Sol::get_objective_value), Sol>::type;
+    auto best = _solve_recursive<State, Sol, Obj, sense>(
+        state, incumbent.get_objective_value());
+    if (best) { return best; }
+    return incumbent;
+}
+
+// Shared state of a parallel recursion: the primal bound and the number of
+// worker threads free to take a forked branch.
+template <typename Obj>
+struct ForkJoinControl {
+    std::atomic<Obj> primal_bound;
+    std::atomic<unsigned> free_workers;
+    unsigned cutoff_depth;
+
+    ForkJoinControl(Obj bound, unsigned threads, unsigned cutoff) :
+        primal_bound(bound), free_workers(threads - 1), cutoff_depth(cutoff) {}
+
+    bool try_acquire() {
+        unsigned free = free_workers.load(std::memory_order_relaxed);
+        while (free > 0) {
+            if (free_workers.compare_exchange_weak(free, free - 1)) { return true; }
+        }
+        return false;
+    }
+
+    void release() { free_workers.fetch_add(1); }
+
+    // Raise the shared primal bound to value if it improves on it. Returns
+    // whether it did.
+    template <Sense sense>
+    bool improve(Obj value) {
+        Obj current = primal_bound.load(std::memory_order_relaxed);
+        while (SenseOps<sense>::is_improvement(value, current)) {
+            if (primal_bound.compare_exchange_weak(current, value)) { return true; }
+        }
+        return false;
+    }
+};
+
+
+// Fork-join variant of _solve_recursive. Above the cutoff depth, if a worker
+// is free, the alternate branch is explored on a clone of the state by a new
+// task while this task explores the main branch. Otherwise it recurses
+// serially. All tasks prune against the shared primal bound, and a solution
+// is only returned by the task which raised the bound to its value, so the
+// best returned solution is optimal.
+//
+// Additionally requires State::clone().
+template <typename State, typename Sol, typename Obj, Sense sense>
+std::optional<Sol> _solve_recursive_parallel(
+        State* state, ForkJoinControl<Obj>* control, unsigned depth) {
+    using opt = SenseOps<sense>;
+    if (opt::can_be_pruned(*state, control->primal_bound.load(std::memory_order_relaxed)))
+        return std::nullopt;
+    if (!state->is_feasible())
+        return std::nullopt;
+    if (state->is_leaf()) {
+        auto solution = state->get_solution();
+        if (control->template improve<sense>(solution.get_objective_value()))
+            return solution;
+        return std::nullopt;
+    }
+    if (depth >= control->cutoff_depth || !control->try_acquire()) {
+        // Serial step; the subtree may still fork above the cutoff.
+        auto [rule, first_result] = state->branch();
+        auto best = _solve_recursive_parallel<State, Sol, Obj, sense>(state, control, depth + 1);
+        state->backtrack(rule, first_result);
+        auto second_result = state->branch_alternate(rule);
+        auto other = _solve_recursive_parallel<State, Sol, Obj, sense>(state, control, depth + 1);
+        state->backtrack(rule, second_result);
+        if ((!best) || (other && opt::is_improvement(
+                other->get_objective_value(), best->get_objective_value())))
+            return other;
+        return best;
+    }
+    // Fork the alternate branch onto a clone of this state.
+    State fork = state->clone();
+    auto [rule, first_result] = state->branch();
+    auto forked = std::async(std::launch::async,
+        [control, depth, rule = rule, fork = std::move(fork)]() mutable {
+            auto result = fork.branch_alternate(rule);
+            auto other = _solve_recursive_parallel<State, Sol, Obj, sense>(
+                &fork, control, depth + 1);
+            fork.backtrack(rule, result);
+            control->release();
+            return other;
+        });
+    auto best = _solve_recursive_parallel<State, Sol, Obj, sense>(state, control, depth + 1);
+    state->backtrack(rule, first_result);
+    auto other = forked.get();
+    if ((!best) || (other && opt::is_improvement(
+            other->get_objective_value(), best->get_objective_value())))
+        return other;
+    return best;
+}
+
+
+template <typename State, Sense sense>
+auto solve_recursive_parallel(State* state, unsigned threads, unsigned cutoff_depth) {
+    using Sol = typename std::invoke_result<decltype(&State::get_solution), State>::type;
+    using Obj = typename std::invoke_result<decltype(&Sol::get_objective_value), Sol>::type;
+    Expects(threads > 0);
+    ForkJoinControl<Obj> control(initial_primal_bound<Obj, sense>(), threads, cutoff_depth);
+    return _solve_recursive_parallel<State, Sol, Obj, sense>(state, &control, 0);
+}
+
+// Start from a known solution, as solve_recursive.
+template <typename State, Sense sense, typename Sol>
+std::optional<Sol> solve_recursive_parallel(
+        State* state, unsigned threads, unsigned cutoff_depth, Sol incumbent) {
+    using Obj = typename std::invoke_result<decltype(&Sol::get_objective_value), Sol>::type;
+    Expects(threads > 0);
+    ForkJoinControl<Obj> control(incumbent.get_objective_value(), threads, cutoff_depth);
+    auto best = _solve_recursive_parallel<State, Sol, Obj, sense>(state, &control, 0);
+    if (best) { return best; }
+    return incumbent;
+}
+
 #endif  // SRC_RECURSION_HPP
@@ -0,0 +1,128 @@
+#ifndef SRC_ARBORY_REPLAY_HPP_
+#define SRC_ARBORY_REPLAY_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "backtracking.hpp"
+#include "statistics.hpp"
+#include "trace.hpp"
+
+
+struct ReplayResult {
+    unsigned long branches = 0;
+    unsigned long alternates = 0;
+    unsigned long backtracks = 0;
+    unsigned long leaves = 0;
+    double time = 0;                // Seconds, excluding reading the file.
+};
+
+
+// Apply a recorded trace to the state, which must be the same root the
+// trace was recorded from. The state is returned to the root afterwards.
+// Throws std::domain_error if the file is malformed or the state diverges
+// from the trace.
+template <typename State>
+ReplayResult replay_trace(State* state, const std::string& file_name) {
+    using Rule = typename SearchTypes<State>::br_rule;
+    using StackElement = typename SearchTypes<State>::StackElement;
+    static_assert(std::is_trivially_copyable_v<Rule>);
+
+    std::ifstream in(file_name, std::ios::binary);
+    if (!in.is_open()) { throw std::domain_error("Failed to open trace file."); }
+    uint32_t header[3] = {0, 0, 0};
+    in.read(reinterpret_cast<char*>(header), sizeof(header));
+    if (header[0] != trace_magic || header[1] != trace_version) {
+        throw std::domain_error("Not a trace file (or wrong version).");
+    }
+    if (header[2] != sizeof(Rule)) {
+        throw std::domain_error("Trace was recorded with a different rule type.");
+    }
+    const std::vector<char> events(
+        (std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    ReplayResult result;
+    std::vector<StackElement> stack;
+    auto diverged = [](size_t position) {
+        return std::domain_error(
+            "State diverged from the trace at byte " + std::to_string(position) + ".");
+    };
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < events.size(); i++) {
+        auto byte = static_cast<uint8_t>(events[i]);
+        switch (static_cast<TraceEvent>(byte & 0x3)) {
+            case TraceEvent::Branch: {
+                if (i + sizeof(Rule) >= events.size()) {
+                    throw std::domain_error("Truncated trace file.");
+                }
+                auto child = state->branch();
+                if (std::memcmp(&child.first, &events[i + 1], sizeof(Rule)) != 0) {
+                    throw diverged(i);
+                }
+                stack.emplace_back(std::move(child));
+                i += sizeof(Rule);
+                result.branches++;
+                break;
+            }
+            case TraceEvent::Alternate:
+                if (stack.empty() || stack.back().unwind_step(state)) { throw diverged(i); }
+                result.alternates++;
+                break;
+            case TraceEvent::Backtrack:
+                for (unsigned count = byte >> 2; count > 0; count--) {
+                    if (stack.empty() || !stack.back().unwind_step(state)) { throw diverged(i); }
+                    stack.pop_back();
+                    result.backtracks++;
+                }
+                break;
+            case TraceEvent::Leaf:
+                state->get_solution();
+                result.leaves++;
+                break;
+        }
+    }
+    result.time = std::chrono::duration<double>(
+        std::chrono::high_resolution_clock::now() - start).count();
+    // A search stopped by a limit leaves its path unexplored.
+    while (!stack.empty()) {
+        stack.back().backtrack(state);
+        stack.pop_back();
+    }
+    return result;
+}
+
+
+inline void log_replay(const LogOptions& log, const ReplayResult& result) {
+    unsigned long transitions = result.branches + result.alternates + result.backtracks;
+    std::ostream& out = *log.stream;
+    if (log.format == LogFormat::JSON) {
+        out << "{\"event\": \"replay\", \"time\": " << result.time
+            << ", \"branches\": " << result.branches
+            << ", \"alternates\": " << result.alternates
+            << ", \"backtracks\": " << result.backtracks
+            << ", \"leaves\": " << result.leaves << "}" << std::endl;
+    } else {
+        out << "====== REPLAY ======" << std::endl;
+        out << "Branches:    " << result.branches << std::endl;
+        out << "Alternates:  " << result.alternates << std::endl;
+        out << "Backtracks:  " << result.backtracks << std::endl;
+        out << "Leaves:      " << result.leaves << std::endl;
+        out << "Time:        " << result.time << " seconds" << std::endl;
+        out << "Rate:        " << transitions / result.time
+            << " transitions/second" << std::endl;
+        out << "====================" << std::endl;
+    }
+    if (log.report != nullptr) {
+        log_replay(LogOptions(0, LogFormat::JSON, log.report), result);
+    }
+}
+
+#endif  // SRC_ARBORY_REPLAY_HPP_
@@ -26,6 +26,20 @@ bool can_be_pruned_impl(std::false_type, const State& state, const Obj& upper_bo
 }
 
 
+// Maximisation case.
+template <typename State>
+auto dual_bound_impl(std::true_type, const State& state) {
+    return state.get_upper_bound();
+}
+
+
+// Minimisation case.
+template <typename State>
+auto dual_bound_impl(std::false_type, const State& state) {
+    return state.get_lower_bound();
+}
+
+
 // Maximisation case.
 template <typename Obj>
 bool is_improvement_impl(std::true_type, const Obj& objective_value, const Obj& lower_bound) {
@@ -50,6 +64,19 @@ public:
             objective_value, primal_bound);
     }
 
+    // Return whichever of two objective values or bounds is better.
+    template <typename Obj>
+    static Obj best(const Obj& a, const Obj& b) {
+        return is_improvement(a, b) ? a : b;
+    }
+
+    // Best objective value which could be found below the state.
+    template <typename State>
+    static auto dual_bound(const State& state) {
+        return dual_bound_impl(
+            std::bool_constant<sense == Sense::Maximize>(), state);
+    }
+
     template <typename State, typename Obj>
     static bool can_be_pruned(const State& state, const Obj primal_bound) {
         return can_be_pruned_impl(
@@ -0,0 +1,79 @@
+#ifndef SRC_ARBORY_SINKS_HPP_
+#define SRC_ARBORY_SINKS_HPP_
+
+#include <deque>
+#include <functional>
+#include <utility>
+#include <gsl/gsl_assert>
+
+
+// Solution sinks receive each improving solution found by a search engine.
+// Solutions arrive in strictly improving order, so the best solution is
+// always the most recent one. Solution types need not be assignable.
+//
+// Required methods:
+//
+//      Sink:
+//          void add(Sol&& solution)
+//          const std::deque<Sol>& get_solutions() const    // worst to best
+//          const Sol& best() const
+
+
+// Keeps only the best solution found.
+template <typename Sol>
+class KeepBest {
+    std::deque<Sol> solutions;
+public:
+    void add(Sol&& solution) {
+        solutions.clear();
+        solutions.push_back(std::move(solution));
+    }
+    const std::deque<Sol>& get_solutions() const { return solutions; }
+    const Sol& best() const {
+        Expects(!solutions.empty());
+        return solutions.back();
+    }
+};
+
+
+// Keeps the k best solutions found.
+template <typename Sol>
+class KeepTopK {
+    size_t k;
+    std::deque<Sol> solutions;
+public:
+    explicit KeepTopK(size_t k) : k(k), solutions() {
+        Expects(k > 0);
+    }
+    void add(Sol&& solution) {
+        if (solutions.size() == k) {
+            solutions.pop_front();
+        }
+        solutions.push_back(std::move(solution));
+    }
+    const std::deque<Sol>& get_solutions() const { return solutions; }
+    const Sol& best() const {
+        Expects(!solutions.empty());
+        return solutions.back();
+    }
+};
+
+
+// Passes each solution to a callback as it is found (e.g. to write it to a
+// file), keeping only the best one in memory.
+template <typename Sol>
+class StreamSolutions {
+    std::function<void(const Sol&)> callback;
+    KeepBest<Sol> keep;
+public:
+    explicit StreamSolutions(std::function<void(const Sol&)> f) :
+        callback(std::move(f)), keep() {}
+    void add(Sol&& solution) {
+        callback(solution);
+        keep.add(std::move(solution));
+    }
+    const std::deque<Sol>& get_solutions() const { return keep.get_solutions(); }
+    const Sol& best() const { return keep.best(); }
+};
+
+#endif  // SRC_ARBORY_SINKS_HPP_
@@ -0,0 +1,149 @@
+#ifndef SRC_ARBORY_STATISTICS_HPP_
+#define SRC_ARBORY_STATISTICS_HPP_
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "limits.hpp"
+
+
+enum class LogFormat {
+    Text,       // Human-readable progress lines and summary.
+    JSON        // One JSON object per line (progress, incumbents, report).
+};
+
+
+// Where and how a search writes its progress log. Converts from a plain
+// log interval to keep the common case short.
+struct LogOptions {
+    double interval;                    // Seconds between progress lines (0: none).
+    LogFormat format = LogFormat::Text;
+    std::ostream* stream = &std::cout;  // Progress lines and final summary.
+    std::ostream* report = nullptr;     // If set, receives the JSON report.
+
+    LogOptions(double i) : interval(i) {}
+    LogOptions(double i, LogFormat fmt, std::ostream* s = &std::cout,
+               std::ostream* r = nullptr) :
+        interval(i), format(fmt), stream(s), report(r) {}
+};
+
+
+// Counters filled in during search, for finding out where solve time goes.
+template <typename Obj>
+struct SearchStatistics {
+    struct Incumbent {
+        double time;
+        unsigned long nodes;
+        Obj objective;
+    };
+    struct Sample {
+        double time;
+        unsigned long nodes;
+    };
+
+    unsigned long nodes = 0;
+    unsigned long leaves = 0;
+    unsigned long pruned_bound = 0;
+    unsigned long pruned_infeasible = 0;
+    unsigned max_depth = 0;
+    std::vector<unsigned long> depth_histogram;
+    std::vector<Incumbent> incumbents;
+    std::vector<Sample> samples;
+
+    void visit(unsigned depth) {
+        nodes++;
+        if (depth >= depth_histogram.size()) {
+            depth_histogram.resize(depth + 1, 0);
+            max_depth = depth;
+        }
+        depth_histogram[depth]++;
+    }
+
+    void write_json(std::ostream& out) const {
+        out << "{\"nodes\": " << nodes
+            << ", \"leaves\": " << leaves
+            << ", \"pruned_bound\": " << pruned_bound
+            << ", \"pruned_infeasible\": " << pruned_infeasible
+            << ", \"max_depth\": " << max_depth
+            << ", \"time_to_first\": ";
+        if (incumbents.empty()) { out << "null"; } else { out << incumbents.front().time; }
+        out << ", \"time_to_best\": ";
+        if (incumbents.empty()) { out << "null"; } else { out << incumbents.back().time; }
+        out << ", \"depth_histogram\": [";
+        for (size_t i = 0; i < depth_histogram.size(); i++) {
+            out << (i ? ", " : "") << depth_histogram[i];
+        }
+        out << "], \"incumbents\": [";
+        for (size_t i = 0; i < incumbents.size(); i++) {
+            out << (i ? ", " : "")
+                << "{\"time\": " << incumbents[i].time
+                << ", \"nodes\": " << incumbents[i].nodes
+                << ", \"objective\": " << incumbents[i].objective << "}";
+        }
+        // Rate is measured over the interval since the previous sample.
+        out << "], \"rate\": [";
+        double prev_time = 0.0;
+        unsigned long prev_nodes = 0;
+        for (size_t i = 0; i < samples.size(); i++) {
+            double interval = samples[i].time - prev_time;
+            out << (i ? ", " : "")
+                << "{\"time\": " << samples[i].time
+                << ", \"nodes\": " << samples[i].nodes
+                << ", \"nodes_per_second\": "
+                << ((interval > 0) ? (samples[i].nodes - prev_nodes) / interval : 0.0)
+                << "}";
+            prev_time = samples[i].time;
+            prev_nodes = samples[i].nodes;
+        }
+        out << "]}";
+    }
+};
+
+
+// A string as a quoted JSON string, escaping quotes, backslashes and
+// control characters.
+inline std::string json_string(const std::string& text) {
+    static const char hex[] = "0123456789abcdef";
+    std::string quoted = "\"";
+    for (unsigned char c : text) {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+            quoted += c;
+        } else if (c < 0x20) {
+            quoted += "\\u00";
+            quoted += hex[c >> 4];
+            quoted += hex[c & 0xF];
+        } else {
+            quoted += c;
+        }
+    }
+    return quoted + "\"";
+}
+
+
+// Write the outcome of a search as a single-line JSON object. Extra is
+// appended as-is as further fields (e.g. a profile).
+template <typename Sol, typename Obj>
+void write_json_report(
+        std::ostream& out, const SolveResult<Sol, Obj>& result,
+        const SearchStatistics<Obj>& statistics, const std::string& extra = "") {
+    out << "{\"event\": \"report\""
+        << ", \"status\": \"" << status_name(result.status) << "\""
+        << ", \"time\": " << result.time
+        << ", \"nodes\": " << result.nodes
+        << ", \"objective\": ";
+    if (result.solution) { out << result.primal_bound; } else { out << "null"; }
+    out << ", \"dual_bound\": ";
+    if (result.solution || result.status != Status::Optimal) {
+        out << result.dual_bound;
+    } else {
+        out << "null";      // Proven infeasible (or no better than the initial bound).
+    }
+    out << ", \"statistics\": ";
+    statistics.write_json(out);
+    if (!extra.empty()) { out << ", " << extra; }
+    out << "}" << std::endl;
+}
+
+#endif  // SRC_ARBORY_STATISTICS_HPP_
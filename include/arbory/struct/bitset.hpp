@@ -0,0 +1,80 @@
+#ifndef SRC_ARBORY_STRUCT_BITSET_HPP_
+#define SRC_ARBORY_STRUCT_BITSET_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+// Dense sets of vertices stored as arrays of 64-bit words, vertex v in bit
+// v % 64 of word v / 64. The word loops below are simple enough for the
+// compiler to vectorise. Popcounts compile to single instructions where the
+// target has one: release builds enable it on x86-64 (see Makefile.common);
+// elsewhere __builtin_popcountll may be a software routine.
+
+constexpr size_t bitset_words(size_t bits) { return (bits + 63) / 64; }
+
+inline bool test_bit(const uint64_t* words, unsigned v) {
+    return (words[v >> 6] >> (v & 63)) & 1;
+}
+
+inline void set_bit(uint64_t* words, unsigned v) {
+    words[v >> 6] |= uint64_t(1) << (v & 63);
+}
+
+inline void reset_bit(uint64_t* words, unsigned v) {
+    words[v >> 6] &= ~(uint64_t(1) << (v & 63));
+}
+
+inline unsigned popcount(const uint64_t* a, size_t words) {
+    unsigned count = 0;
+    for (size_t i = 0; i < words; i++) { count += __builtin_popcountll(a[i]); }
+    return count;
+}
+
+// Size of the intersection of a and b.
+inline unsigned popcount_and(const uint64_t* a, const uint64_t* b, size_t words) {
+    unsigned count = 0;
+    for (size_t i = 0; i < words; i++) { count += __builtin_popcountll(a[i] & b[i]); }
+    return count;
+}
+
+// out = a & b (out may alias a or b).
+inline void and_words(uint64_t* out, const uint64_t* a, const uint64_t* b, size_t words) {
+    for (size_t i = 0; i < words; i++) { out[i] = a[i] & b[i]; }
+}
+
+// Call f(v) for each set bit v, in increasing order.
+template <typename F>
+void for_each_bit(const uint64_t* a, size_t words, F f) {
+    for (size_t i = 0; i < words; i++) {
+        for (uint64_t word = a[i]; word != 0; word &= word - 1) {
+            f(static_cast<unsigned>(i * 64 + __builtin_ctzll(word)));
+        }
+    }
+}
+
+
+// Owning set of vertices 0..n-1.
+class VertexSet {
+    std::vector<uint64_t> _words;
+public:
+    VertexSet() : _words() {}
+    explicit VertexSet(unsigned n) : _words(bitset_words(n), 0) {}
+
+    size_t words() const { return _words.size(); }
+    uint64_t* data() { return _words.data(); }
+    const uint64_t* data() const { return _words.data(); }
+
+    bool test(unsigned v) const { return test_bit(_words.data(), v); }
+    void set(unsigned v) { set_bit(_words.data(), v); }
+    void reset(unsigned v) { reset_bit(_words.data(), v); }
+    void clear() { std::fill(std::begin(_words), std::end(_words), 0); }
+    unsigned count() const { return popcount(_words.data(), _words.size()); }
+
+    template <typename F>
+    void for_each(F f) const { for_each_bit(_words.data(), _words.size(), f); }
+};
+
+#endif  // SRC_ARBORY_STRUCT_BITSET_HPP_
@@ -2,48 +2,326 @@
 #define SRC_ARBORY_STRUCT_GRAPH_HPP_
 
 #include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <memory>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
+#include <gsl/gsl_assert>
 
+#include "bitset.hpp"
+#include "mapped_file.hpp"
 
-// Undirected graph with N vertices numbered 0..N-1.
+
+// Whether a graph also stores its adjacency as a bit matrix. Auto uses one
+// when it is small in absolute terms or compared to the adjacency lists
+// (i.e. the graph is dense enough); see UndirectedGraph::prefers_matrix.
+enum class AdjacencyMatrix {
+    Auto,
+    Never,
+    Always
+};
+
+
+// Run f(c) for each chunk c on a thread of its own, rethrowing the first
+// exception (if any) once all have finished.
+template <typename F>
+void run_chunks(unsigned chunks, F f) {
+    if (chunks == 1) {
+        f(0u);
+        return;
+    }
+    std::vector<std::thread> workers;
+    std::vector<std::exception_ptr> errors(chunks);
+    for (unsigned c = 0; c < chunks; c++) {
+        workers.emplace_back([&f, &errors, c]() {
+            try { f(c); } catch (...) { errors[c] = std::current_exception(); }
+        });
+    }
+    for (auto& worker : workers) { worker.join(); }
+    for (const auto& error : errors) {
+        if (error) { std::rethrow_exception(error); }
+    }
+}
+
+
+// Contiguous range of a vertex's neighbours, in increasing order.
+class NeighbourRange {
+    const unsigned* first;
+    const unsigned* last;
+public:
+    NeighbourRange(const unsigned* f, const unsigned* l) : first(f), last(l) {}
+    const unsigned* begin() const { return first; }
+    const unsigned* end() const { return last; }
+    size_t size() const { return last - first; }
+    bool empty() const { return first == last; }
+    unsigned operator[](size_t i) const { return first[i]; }
+};
+
+
+// Undirected graph with N vertices numbered 0..N-1, stored in compressed
+// sparse rows (one offsets array and one neighbour array, each row sorted)
+// and, optionally, a bit matrix whose rows are VertexSets (see bitset.hpp)
+// for O(1) adjacent() and word-parallel set operations. The arrays are
+// immutable once built and shared by copies; they are held either in
+// memory or in a mapped binary graph file (see write_binary).
 class UndirectedGraph {
-    std::vector<std::vector<unsigned>> _adjacent;
-    unsigned _edges;
+    // Arrays of a graph built in memory.
+    struct Storage {
+        std::vector<size_t> offsets;
+        std::vector<unsigned> neighbours;
+        std::vector<uint64_t> matrix;
+        size_t row_words = 0;
+    };
+
+    // Owner of the arrays below (Storage or MappedFile).
+    std::shared_ptr<const void> _owner;
+    unsigned _vertices;
+    // Neighbours of i are _neighbours[_offsets[i]] .. _neighbours[_offsets[i + 1] - 1].
+    const size_t* _offsets;
+    const unsigned* _neighbours;
+    // Row i occupies words [i * _row_words, (i + 1) * _row_words); null if
+    // there is no matrix.
+    const uint64_t* _matrix;
+    size_t _row_words;
+
+    UndirectedGraph() :
+        _owner(), _vertices(0), _offsets(nullptr), _neighbours(nullptr),
+        _matrix(nullptr), _row_words(0) {}
+    // Sort each row (in parallel for large graphs) and remove repeats.
+    static void sort_rows(Storage& storage);
+    static void build_matrix(Storage& storage);
+
+    // Count degrees, then fill rows, in two passes over the edges.
+    template <typename ForEachEdge>
+    static void fill_rows(Storage& storage, unsigned n, ForEachEdge&& for_each_edge) {
+        auto& offsets = storage.offsets;
+        offsets.assign(n + 1, 0);
+        for_each_edge([&offsets, n](unsigned i, unsigned j) {
+            Expects(i < n && j < n);
+            if (i != j) {
+                offsets[i + 1]++;
+                offsets[j + 1]++;
+            }
+        });
+        for (unsigned i = 0; i < n; i++) { offsets[i + 1] += offsets[i]; }
+        auto& neighbours = storage.neighbours;
+        neighbours.resize(offsets[n]);
+        // offsets[i] is used as the fill position of row i, which leaves it
+        // at the start of row i + 1.
+        for_each_edge([&offsets, &neighbours](unsigned i, unsigned j) {
+            if (i != j) {
+                Expects(offsets[i] < neighbours.size() && offsets[j] < neighbours.size());
+                neighbours[offsets[i]++] = j;
+                neighbours[offsets[j]++] = i;
+            }
+        });
+        Expects(n == 0 || offsets[n - 1] == offsets[n]);
+        for (unsigned i = n; i > 0; i--) { offsets[i] = offsets[i - 1]; }
+        offsets[0] = 0;
+    }
+
+    // Sort the filled rows, add the matrix if chosen and take ownership.
+    static UndirectedGraph finish(Storage&& storage, AdjacencyMatrix matrix) {
+        sort_rows(storage);
+        const unsigned n = storage.offsets.size() - 1;
+        if (matrix == AdjacencyMatrix::Always
+                || (matrix == AdjacencyMatrix::Auto
+                    && prefers_matrix(n, storage.neighbours.size() / 2))) {
+            build_matrix(storage);
+        }
+        auto owner = std::make_shared<const Storage>(std::move(storage));
+        UndirectedGraph graph;
+        graph._vertices = n;
+        graph._offsets = owner->offsets.data();
+        graph._neighbours = owner->neighbours.data();
+        graph._matrix = owner->matrix.empty() ? nullptr : owner->matrix.data();
+        graph._row_words = owner->row_words;
+        graph._owner = std::move(owner);
+        return graph;
+    }
+
+    static UndirectedGraph parse_dimacs(
+        const MappedFile& file, const std::string& file_name, unsigned threads);
+    static UndirectedGraph open_binary(
+        std::shared_ptr<const MappedFile> file, const std::string& file_name);
+
 public:
-    // Construct from edge list (assumes no repetition of pairs).
-    UndirectedGraph(unsigned n, std::vector<std::pair<unsigned, unsigned>> edges)
-        : _adjacent(n), _edges(edges.size())
-    {
-        for (auto [i, j] : edges) {
-            _adjacent[i].push_back(j);
-            _adjacent[j].push_back(i);
+    // Matrices up to this size are always used by Auto.
+    static constexpr size_t matrix_small_bytes = size_t(1) << 20;
+    // Larger matrices are used if no more than this many times the size of
+    // the adjacency lists, up to matrix_max_bytes.
+    static constexpr size_t matrix_list_ratio = 16;
+    static constexpr size_t matrix_max_bytes = size_t(1) << 28;
+    // Rows are sorted on several threads above this many neighbour entries.
+    static constexpr size_t parallel_sort_entries = size_t(1) << 20;
+
+    // Size of the bit matrix of a graph with n vertices.
+    static size_t matrix_bytes(unsigned n) {
+        return size_t(n) * bitset_words(n) * sizeof(uint64_t);
+    }
+
+    static bool prefers_matrix(unsigned n, size_t edges) {
+        size_t bytes = matrix_bytes(n);
+        size_t list_bytes = 2 * edges * sizeof(unsigned);
+        return (bytes <= matrix_small_bytes)
+            || (bytes <= matrix_max_bytes && bytes <= matrix_list_ratio * list_bytes);
+    }
+
+    // Build from a sequence of edges without holding a copy of it: calling
+    // for_each_edge(f) must call f(i, j) for each edge, and is done twice
+    // (count degrees, then fill rows), so it must give the same edges both
+    // times. Repeated pairs (in either order) and self-loops are dropped, so
+    // peak memory is the final structure plus any repeats.
+    template <typename ForEachEdge>
+    static UndirectedGraph from_edges(
+            unsigned n, ForEachEdge for_each_edge,
+            AdjacencyMatrix matrix = AdjacencyMatrix::Auto) {
+        Storage storage;
+        fill_rows(storage, n, for_each_edge);
+        return finish(std::move(storage), matrix);
+    }
+
+    // As from_edges, with the edges split into chunks which are read in
+    // parallel: for_each_edge(c, f) calls f(i, j) for each edge of chunk c.
+    // Each chunk needs its own array of row positions (n + 1 words).
+    template <typename ForEachEdgeInChunk>
+    static UndirectedGraph from_edge_chunks(
+            unsigned n, unsigned chunks, ForEachEdgeInChunk for_each_edge,
+            AdjacencyMatrix matrix = AdjacencyMatrix::Auto) {
+        Expects(chunks > 0);
+        Storage storage;
+        if (chunks == 1) {
+            fill_rows(storage, n, [&for_each_edge](auto add) { for_each_edge(0u, add); });
+            return finish(std::move(storage), matrix);
         }
+        // positions[c][i + 1] counts chunk c's entries in row i, then becomes
+        // chunk c's fill position in row i.
+        std::vector<std::vector<size_t>> positions(chunks);
+        run_chunks(chunks, [&positions, &for_each_edge, n](unsigned c) {
+            auto& count = positions[c];
+            count.assign(n + 1, 0);
+            for_each_edge(c, [&count, n](unsigned i, unsigned j) {
+                Expects(i < n && j < n);
+                if (i != j) {
+                    count[i + 1]++;
+                    count[j + 1]++;
+                }
+            });
+        });
+        auto& offsets = storage.offsets;
+        offsets.assign(n + 1, 0);
         for (unsigned i = 0; i < n; i++) {
-            auto& ref = _adjacent[i];
-            std::sort(std::begin(ref), std::end(ref));
+            size_t position = offsets[i];
+            for (auto& chunk : positions) {
+                size_t count = chunk[i + 1];
+                chunk[i] = position;
+                position += count;
+            }
+            offsets[i + 1] = position;
         }
+        auto& neighbours = storage.neighbours;
+        neighbours.resize(offsets[n]);
+        run_chunks(chunks, [&positions, &for_each_edge, &neighbours](unsigned c) {
+            auto& position = positions[c];
+            for_each_edge(c, [&position, &neighbours](unsigned i, unsigned j) {
+                if (i != j) {
+                    Expects(position[i] < neighbours.size() && position[j] < neighbours.size());
+                    neighbours[position[i]++] = j;
+                    neighbours[position[j]++] = i;
+                }
+            });
+        });
+        positions.clear();
+        return finish(std::move(storage), matrix);
     }
+
+    // Construct from edge list.
+    UndirectedGraph(unsigned n, const std::vector<std::pair<unsigned, unsigned>>& edges,
+                    AdjacencyMatrix matrix = AdjacencyMatrix::Auto) :
+        UndirectedGraph(from_edges(n, [&edges](auto add) {
+            for (auto [i, j] : edges) { add(i, j); }
+        }, matrix)) {}
+
     // Accessors
-    unsigned vertices() const { return _adjacent.size(); }
-    unsigned edges() const { return _edges; }
-    unsigned degree(unsigned i) const { return _adjacent[i].size(); }
+    unsigned vertices() const { return _vertices; }
+    unsigned edges() const { return _offsets[_vertices] / 2; }
+    unsigned degree(unsigned i) const { return _offsets[i + 1] - _offsets[i]; }
     // Return whether an edge exists between i and j.
     bool adjacent(const unsigned i, const unsigned j) const {
-        const auto& ref = _adjacent[i];
+        if (_matrix != nullptr) {
+            return test_bit(_matrix + i * _row_words, j);
+        }
+        const auto ref = (*this)[i];
         return std::binary_search(std::begin(ref), std::end(ref), j);
     }
-    const std::vector<unsigned>& operator[](unsigned i) const {
-        return _adjacent[i];
+    bool has_matrix() const { return _matrix != nullptr; }
+    // Neighbours of i as a bitset of bitset_words(vertices()) words (matrix
+    // only).
+    const uint64_t* row(unsigned i) const {
+        Expects(has_matrix());
+        return _matrix + i * _row_words;
+    }
+    // Number of neighbours of v in the set (of this graph's vertices).
+    unsigned count_neighbours(unsigned v, const VertexSet& set) const {
+        if (has_matrix()) {
+            return popcount_and(row(v), set.data(), _row_words);
+        }
+        unsigned count = 0;
+        for (auto w : (*this)[v]) { count += set.test(w); }
+        return count;
+    }
+    // Write the neighbours of v in the set to out (which may be the set).
+    void neighbours_in(unsigned v, const VertexSet& set, VertexSet* out) const {
+        if (has_matrix()) {
+            and_words(out->data(), row(v), set.data(), _row_words);
+            return;
+        }
+        VertexSet result(vertices());
+        for (auto w : (*this)[v]) {
+            if (set.test(w)) { result.set(w); }
+        }
+        *out = std::move(result);
+    }
+    NeighbourRange operator[](unsigned i) const {
+        return NeighbourRange(
+            _neighbours + _offsets[i], _neighbours + _offsets[i + 1]);
     }
     // Read a DIMACS file (format below) and return the graph object.
     //
-    //   p edges N M
+    //   c comment
+    //   p edge N M
     //   e i j
     //   ...
     //
-    static UndirectedGraph read_dimacs(std::string file_name);
+    // Any word is accepted after p (edge, edges, col, ...), other line types
+    // are skipped and fields may be separated by any spaces or tabs. The
+    // file is memory-mapped and parsed in place; with more than one thread
+    // (0: one per core for files over parallel_parse_bytes) it is parsed in
+    // chunks.
+    static UndirectedGraph read_dimacs(std::string file_name, unsigned threads = 0);
+    static constexpr size_t parallel_parse_bytes = size_t(1) << 24;
+
+    // Write the graph in the binary format, which read_binary maps back
+    // without parsing, copying or sorting, so that loading is near-instant
+    // and processes solving the same graph share its pages. In host byte
+    // order, with each array starting on an 8-byte boundary:
+    //
+    //   header     magic, version (32 bits each), then vertices N, neighbour
+    //              entries E (2 per edge) and matrix row words W (0 if none)
+    //   offsets    N + 1 row offsets (64 bits each)
+    //   neighbours E vertices (32 bits each)
+    //   matrix     N * W words (64 bits each)
+    //
+    // The matrix is stored if the graph has one.
+    void write_binary(const std::string& file_name) const;
+    static UndirectedGraph read_binary(const std::string& file_name);
+    static constexpr uint32_t binary_magic = 0x47425241;  // "ARBG"
+    static constexpr uint32_t binary_version = 1;
+    // Read a file in either format, telling them apart by the magic number.
+    static UndirectedGraph read(const std::string& file_name);
 };
 
 #endif  // SRC_ARBORY_STRUCT_GRAPH_HPP_
@@ -0,0 +1,57 @@
+#ifndef SRC_ARBORY_STRUCT_MAPPED_FILE_HPP_
+#define SRC_ARBORY_STRUCT_MAPPED_FILE_HPP_
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+// Read-only memory mapping of a whole file. Pages are shared with the page
+// cache, so the file is never copied into the process and processes which
+// map the same file share its memory.
+class MappedFile {
+    const char* _data;
+    size_t _size;
+
+public:
+    explicit MappedFile(const std::string& file_name) : _data(nullptr), _size(0) {
+        int fd = ::open(file_name.c_str(), O_RDONLY);
+        if (fd < 0) { throw std::runtime_error("Failed to open " + file_name + "."); }
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Failed to stat " + file_name + ".");
+        }
+        _size = info.st_size;
+        if (_size > 0) {
+            void* data = ::mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+            if (data == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("Failed to map " + file_name + ".");
+            }
+            ::madvise(data, _size, MADV_WILLNEED);
+            _data = static_cast<const char*>(data);
+        }
+        // The mapping stays valid after the descriptor is closed.
+        ::close(fd);
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept :
+        _data(std::exchange(other._data, nullptr)), _size(std::exchange(other._size, 0)) {}
+    ~MappedFile() {
+        if (_data != nullptr) { ::munmap(const_cast<char*>(_data), _size); }
+    }
+
+    const char* begin() const { return _data; }
+    const char* end() const { return _data + _size; }
+    size_t size() const { return _size; }
+};
+
+#endif  // SRC_ARBORY_STRUCT_MAPPED_FILE_HPP_
@@ -0,0 +1,55 @@
+#ifndef SRC_ARBORY_STRUCT_RELABEL_HPP_
+#define SRC_ARBORY_STRUCT_RELABEL_HPP_
+
+#include <string>
+#include <vector>
+
+#include "graph.hpp"
+
+
+// Vertex numberings which place vertices that are accessed together close
+// to each other, so that searches touch fewer cache lines in state arrays,
+// adjacency rows and bit matrix words.
+enum class VertexOrder {
+    Input,          // As given.
+    Degree,         // Non-increasing degree.
+    Degeneracy,     // Reverse of the smallest-last order: the densest core first.
+    ReverseCuthillMcKee     // Breadth-first from low degree vertices, reversed
+                            // (small bandwidth: neighbours get nearby numbers).
+};
+
+// Parse input, degree, degeneracy or rcm.
+VertexOrder parse_vertex_order(const std::string& name);
+
+// Vertices of the graph in the given order. Ties are broken on vertex
+// number, so the result depends only on the graph.
+std::vector<unsigned> vertex_order(const UndirectedGraph& graph, VertexOrder order);
+
+
+// Copy of a graph with vertex order[k] renumbered k, which keeps the
+// original numbers to map solutions back.
+class RelabeledGraph {
+    UndirectedGraph _graph;
+    std::vector<unsigned> _original;
+public:
+    RelabeledGraph(const UndirectedGraph& graph, std::vector<unsigned> order,
+                   AdjacencyMatrix matrix);
+    RelabeledGraph(const UndirectedGraph& graph, VertexOrder order, AdjacencyMatrix matrix) :
+        RelabeledGraph(graph, vertex_order(graph, order), matrix) {}
+    // The copy has a bit matrix if the graph has one.
+    RelabeledGraph(const UndirectedGraph& graph, VertexOrder order) :
+        RelabeledGraph(graph, order, graph.has_matrix()
+                       ? AdjacencyMatrix::Always : AdjacencyMatrix::Never) {}
+
+    const UndirectedGraph& graph() const { return _graph; }
+    // Number in the original graph of vertex v of the relabeled graph.
+    unsigned original(unsigned v) const { return _original[v]; }
+    std::vector<unsigned> original(const std::vector<unsigned>& vertices) const {
+        std::vector<unsigned> result;
+        result.reserve(vertices.size());
+        for (auto v : vertices) { result.push_back(_original[v]); }
+        return result;
+    }
+};
+
+#endif  // SRC_ARBORY_STRUCT_RELABEL_HPP_
@@ -0,0 +1,95 @@
+#ifndef SRC_ARBORY_TRACE_HPP_
+#define SRC_ARBORY_TRACE_HPP_
+
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+
+// Search traces: the exact sequence of transitions made by a depth-first
+// search (see Solver::set_trace), which can be replayed against a fresh
+// root state without any of the feasibility, bound or leaf checks (see
+// replay.hpp). Replay times the state transitions alone on the same work
+// every run, so state implementations can be compared independently of
+// search-order effects.
+//
+// File layout (native byte order): magic, version, rule size, then one byte
+// per event holding the event type in the low 2 bits. Branch events are
+// followed by the branch rule; consecutive backtracks are run-length coded
+// with the count (1-63) in the high 6 bits. Rules must be trivially copyable
+// and are compared bytewise on replay, to detect a state whose branch()
+// differs from the one which was recorded.
+
+
+enum class TraceEvent : uint8_t {
+    Branch,         // branch() to the main child, pushing a stack node.
+    Alternate,      // Backtrack the head node's main branch, then branch_alternate().
+    Backtrack,      // Backtrack the head node's alternate branch and pop it.
+    Leaf            // get_solution() at the current state.
+};
+
+constexpr uint32_t trace_magic = 0x54524241;       // "ABRT"
+constexpr uint32_t trace_version = 1;
+
+
+template <typename Rule>
+class TraceWriter {
+    static_assert(std::is_trivially_copyable_v<Rule>);
+    static constexpr size_t flush_size = 1 << 16;
+    static constexpr size_t max_run = 63;
+
+    std::ofstream out;
+    std::vector<char> buffer;
+
+    void put(TraceEvent event, size_t count = 0) {
+        buffer.push_back(static_cast<char>(static_cast<uint8_t>(event) | (count << 2)));
+    }
+
+    void flush() {
+        out.write(buffer.data(), buffer.size());
+        buffer.clear();
+        if (!out) { throw std::runtime_error("Failed to write trace."); }
+    }
+
+    template <typename T>
+    void write_raw(const T& value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+public:
+    explicit TraceWriter(const std::string& file_name) :
+            out(file_name, std::ios::binary | std::ios::trunc), buffer() {
+        if (!out.is_open()) { throw std::runtime_error("Failed to open trace file."); }
+        buffer.reserve(flush_size + sizeof(Rule) + 1);
+        write_raw(trace_magic);
+        write_raw(trace_version);
+        write_raw(static_cast<uint32_t>(sizeof(Rule)));
+    }
+
+    void branch(const Rule& rule) {
+        put(TraceEvent::Branch);
+        const char* bytes = reinterpret_cast<const char*>(&rule);
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(Rule));
+        if (buffer.size() >= flush_size) { flush(); }
+    }
+
+    void alternate() { put(TraceEvent::Alternate); }
+
+    void backtrack(size_t count) {
+        for (; count > max_run; count -= max_run) { put(TraceEvent::Backtrack, max_run); }
+        if (count > 0) { put(TraceEvent::Backtrack, count); }
+    }
+
+    void leaf() { put(TraceEvent::Leaf); }
+
+    void close() {
+        flush();
+        out.close();
+    }
+};
+
+
+#endif  // SRC_ARBORY_TRACE_HPP_
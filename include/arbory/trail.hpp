@@ -0,0 +1,66 @@
+#ifndef SRC_ARBORY_TRAIL_HPP_
+#define SRC_ARBORY_TRAIL_HPP_
+
+#include <cstddef>
+#include <vector>
+#include <gsl/gsl_assert>
+
+
+// Undo trail: a single stack-ordered buffer in which a state records the
+// changes made by each branch, so branch results only need to hold the
+// offset at which their records start (a mark) instead of owning containers.
+// Since search engines always backtrack in the reverse order of branching,
+// backtracking reads the records above the mark and then pops back to it.
+//
+// The buffer only grows, so once it reaches the maximum depth of the search
+// no further allocations are made. It is copied along with its state by
+// clone(), so marks stay valid in the copy.
+//
+//      auto mark = trail.mark();
+//      trail.push(x); ...              // in branch()
+//      for (auto x : trail.since(mark)) { ... }
+//      trail.pop_to(mark);             // in backtrack()
+//
+template <typename T>
+class UndoTrail {
+    std::vector<T> entries;
+
+public:
+    using Mark = size_t;
+
+    // A contiguous range of records, oldest first.
+    class Range {
+        const T* first;
+        const T* last;
+    public:
+        Range(const T* f, const T* l) : first(f), last(l) {}
+        const T* begin() const { return first; }
+        const T* end() const { return last; }
+        size_t size() const { return last - first; }
+    };
+
+    UndoTrail() : entries() {}
+    explicit UndoTrail(size_t capacity) : entries() { entries.reserve(capacity); }
+
+    Mark mark() const { return entries.size(); }
+    void push(const T& value) { entries.push_back(value); }
+    size_t size() const { return entries.size(); }
+    size_t capacity() const { return entries.capacity(); }
+
+    // Records pushed in [from, to).
+    Range between(Mark from, Mark to) const {
+        Expects(from <= to && to <= entries.size());
+        return Range(entries.data() + from, entries.data() + to);
+    }
+
+    // Records pushed since the mark.
+    Range since(Mark from) const { return between(from, entries.size()); }
+
+    // Discard records pushed since the mark.
+    void pop_to(Mark from) {
+        Expects(from <= entries.size());
+        entries.resize(from);
+    }
+};
+
+#endif  // SRC_ARBORY_TRAIL_HPP_
@@ -0,0 +1,200 @@
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+#include "../include/arbory/coordinator.hpp"
+
+using namespace std;
+
+
+namespace {
+
+struct Child {
+    string prefix;
+    string report;
+    string output;
+};
+
+
+// Stops the children still running and removes the subproblem directory
+// with everything in it when the coordinator returns or throws.
+class Cleanup {
+    string dir;
+    const map<pid_t, Child>& running;
+public:
+    Cleanup(string d, const map<pid_t, Child>& r) : dir(move(d)), running(r) {}
+    Cleanup(const Cleanup&) = delete;
+    Cleanup& operator=(const Cleanup&) = delete;
+    ~Cleanup() {
+        for (const auto& entry : running) { kill(entry.first, SIGTERM); }
+        for (const auto& entry : running) {
+            while (waitpid(entry.first, nullptr, 0) < 0 && errno == EINTR) {}
+        }
+        if (DIR* files = opendir(dir.c_str())) {
+            while (dirent* file = readdir(files)) {
+                string name = file->d_name;
+                if (name != "." && name != "..") { unlink((dir + "/" + name).c_str()); }
+            }
+            closedir(files);
+        }
+        rmdir(dir.c_str());
+    }
+};
+
+
+// Raw text of a top-level field in a single-line JSON object (strings are
+// unquoted). Fields are found by their first occurrence, so this relies on
+// the report writing its top-level fields before nested objects.
+optional<string> json_field(const string& line, const string& key) {
+    string pattern = "\"" + key + "\": ";
+    auto pos = line.find(pattern);
+    if (pos == string::npos) { return nullopt; }
+    pos += pattern.size();
+    if (line[pos] == '"') {
+        return line.substr(pos + 1, line.find('"', pos + 1) - pos - 1);
+    }
+    return line.substr(pos, line.find_first_of(",}", pos) - pos);
+}
+
+
+Status parse_status(const string& name) {
+    for (Status status : {Status::Optimal, Status::TimeLimit, Status::NodeLimit,
+                          Status::GapLimit, Status::Interrupted}) {
+        if (name == status_name(status)) { return status; }
+    }
+    throw domain_error("Unknown status in subproblem report.");
+}
+
+
+string read_file(const string& file_name) {
+    ifstream file(file_name);
+    stringstream contents;
+    contents << file.rdbuf();
+    return contents.str();
+}
+
+
+// Fork and exec a child with stdout redirected to a file.
+pid_t launch(const vector<string>& args, const string& output) {
+    vector<char*> argv;
+    for (const auto& arg : args) {
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+    pid_t pid = fork();
+    if (pid < 0) {
+        throw runtime_error("Failed to fork subproblem process.");
+    } else if (pid == 0) {
+        // Only async-signal-safe calls between fork and exec.
+        int fd = open(output.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) { _exit(127); }
+        dup2(fd, STDOUT_FILENO);
+        close(fd);
+        execv(argv[0], argv.data());
+        _exit(127);
+    }
+    return pid;
+}
+
+}  // namespace
+
+
+CoordinatorResult coordinate_subproblems(
+        const vector<string>& prefixes, const SubproblemCommand& command,
+        unsigned processes, Sense sense, ostream& log,
+        const atomic<bool>* interrupt) {
+    auto start = chrono::high_resolution_clock::now();
+    auto elapsed = [start]() {
+        return chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+    };
+    auto improves = [sense](double a, double b) {
+        return (sense == Sense::Maximize) ? (a > b) : (a < b);
+    };
+    char dir_template[] = "/tmp/arbory.XXXXXX";
+    const char* dir = mkdtemp(dir_template);
+    if (dir == nullptr) {
+        throw runtime_error("Failed to create subproblem directory.");
+    }
+
+    CoordinatorResult result{Status::Optimal, nullopt, "", "", 0, 0, 0.0};
+    deque<string> queue(begin(prefixes), end(prefixes));
+    map<pid_t, Child> running;
+    Cleanup cleanup(dir, running);
+    while (!queue.empty() || !running.empty()) {
+        bool stopping = (interrupt != nullptr) && interrupt->load(memory_order_relaxed);
+        while (!stopping && !queue.empty() && running.size() < processes) {
+            string base = string(dir) + "/" + to_string(result.subproblems++);
+            Child child{queue.front(), base + ".json", base + ".out"};
+            queue.pop_front();
+            pid_t pid = launch(command(child.prefix, result.objective, child.report), child.output);
+            running.emplace(pid, move(child));
+        }
+        if (running.empty()) { break; }
+        int wstatus;
+        pid_t pid = waitpid(-1, &wstatus, 0);
+        if (pid < 0) {
+            if (errno == EINTR) { continue; }
+            throw runtime_error("Failed to wait for subproblem process.");
+        }
+        auto it = running.find(pid);
+        if (it == running.end()) { continue; }
+        Child child = move(it->second);
+        running.erase(it);
+        if (!WIFEXITED(wstatus) || WEXITSTATUS(wstatus) != 0) {
+            throw runtime_error("Subproblem '" + child.prefix + "' failed.");
+        }
+        // The report is the last line written to the report file.
+        string line, report;
+        ifstream report_file(child.report);
+        while (getline(report_file, line)) {
+            if (!line.empty()) { report = line; }
+        }
+        auto status_field = json_field(report, "status");
+        auto objective_field = json_field(report, "objective");
+        if (!status_field || !objective_field) {
+            throw runtime_error("Subproblem '" + child.prefix + "' wrote no report.");
+        }
+        Status status = parse_status(*status_field);
+        if (*objective_field != "null") {
+            double objective = stod(*objective_field);
+            if (!result.objective || improves(objective, *result.objective)) {
+                result.objective = objective;
+                result.best_prefix = child.prefix;
+                result.best_output = read_file(child.output);
+                log << "*  TIME: " << elapsed() << "s"
+                    << "  PREFIX: " << child.prefix
+                    << "  PRIMAL: " << objective << endl;
+            }
+        }
+        if (status == Status::Interrupted) {
+            queue.push_front(child.prefix);
+        } else if (status != Status::Optimal) {
+            // Unfinished: split it so the halves can run in parallel.
+            queue.push_back(child.prefix + "0");
+            queue.push_back(child.prefix + "1");
+            result.resplits++;
+        }
+        log << "   TIME: " << elapsed() << "s"
+            << "  PREFIX: " << child.prefix
+            << "  STATUS: " << status_name(status)
+            << "  QUEUED: " << queue.size()
+            << "  RUNNING: " << running.size() << endl;
+        unlink(child.report.c_str());
+        unlink(child.output.c_str());
+    }
+    if (!queue.empty()) { result.status = Status::Interrupted; }
+    result.time = elapsed();
+    return result;
+}
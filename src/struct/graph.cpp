@@ -1,41 +1,274 @@
-
+#include <cstring>
 #include <fstream>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
 
 #include <gsl/gsl_assert>
 
 #include "../../include/arbory/struct/graph.hpp"
+#include "../../include/arbory/struct/mapped_file.hpp"
 
 using namespace std;
 
 
-UndirectedGraph UndirectedGraph::read_dimacs(string file_name) {
-    unsigned vertices = 0, edges = 0;
-    vector<pair<unsigned, unsigned>> edge_list;
-    string line;
-    ifstream col_file(file_name);
-    if (col_file.is_open()) {
-        while ( getline(col_file, line) ) {
-            if (line.substr(0, 1).compare("p") == 0) {
-                Expects(vertices == 0);
-                string info = line.substr(7, line.size());
-                auto found = info.find(" ");
-                vertices = stoi(info.substr(0, found));
-                edges = stoi(info.substr(found + 1, info.size()));
-                edge_list.reserve(edges);
-            } else if (line.substr(0, 1).compare("e") == 0) {
-                Expects(vertices > 0);
-                string info = line.substr(2, line.size());
-                auto found = info.find(" ");
-                unsigned a = stoi(info.substr(0, found));
-                unsigned b = stoi(info.substr(found + 1, info.size()));
-                edge_list.emplace_back(a - 1, b - 1);
+namespace {
+
+// Scanning helpers for DIMACS text, working directly on the mapped buffer.
+
+bool is_blank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+const char* skip_blanks(const char* position, const char* end) {
+    while (position != end && is_blank(*position)) { position++; }
+    return position;
+}
+
+// Start of the line after the one containing position.
+const char* next_line(const char* position, const char* end) {
+    while (position != end && *position != '\n') { position++; }
+    return (position == end) ? end : position + 1;
+}
+
+// Parse a decimal number after optional blanks. Returns the position after
+// it, or nullptr (also if position is nullptr) if there is none.
+const char* parse_number(const char* position, const char* end, uint64_t* value) {
+    if (position == nullptr) { return nullptr; }
+    position = skip_blanks(position, end);
+    if (position == end || *position < '0' || *position > '9') { return nullptr; }
+    uint64_t result = 0;
+    for (; position != end && *position >= '0' && *position <= '9'; position++) {
+        if (result > (numeric_limits<uint64_t>::max() - 9) / 10) { return nullptr; }
+        result = result * 10 + (*position - '0');
+    }
+    *value = result;
+    return position;
+}
+
+// Start of a binary graph file (see UndirectedGraph::write_binary).
+struct BinaryHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t vertices;
+    uint64_t entries;
+    uint64_t row_words;
+};
+static_assert(sizeof(BinaryHeader) == 32, "binary graph header must be packed");
+static_assert(sizeof(size_t) == sizeof(uint64_t) && sizeof(unsigned) == sizeof(uint32_t),
+              "binary graphs are mapped in place");
+
+// Bytes rounded up to whole 8-byte words.
+size_t aligned(size_t bytes) { return (bytes + 7) / 8 * 8; }
+
+}  // namespace
+
+
+void UndirectedGraph::sort_rows(Storage& storage) {
+    auto& offsets = storage.offsets;
+    auto& neighbours = storage.neighbours;
+    const unsigned n = offsets.size() - 1;
+    vector<unsigned> degrees(n);
+    auto sort_range = [&offsets, &neighbours, &degrees](unsigned first, unsigned last) {
+        for (unsigned i = first; i < last; i++) {
+            auto row_begin = begin(neighbours) + offsets[i];
+            auto row_end = begin(neighbours) + offsets[i + 1];
+            sort(row_begin, row_end);
+            degrees[i] = unique(row_begin, row_end) - row_begin;
+        }
+    };
+    unsigned threads = (neighbours.size() >= parallel_sort_entries)
+        ? max(1u, thread::hardware_concurrency()) : 1;
+    // Split rows into blocks of about the same number of entries.
+    vector<unsigned> bounds{0};
+    for (unsigned t = 1; t < threads; t++) {
+        size_t target = neighbours.size() * t / threads;
+        bounds.push_back(upper_bound(
+            begin(offsets) + bounds.back(), end(offsets) - 1, target) - begin(offsets));
+    }
+    bounds.push_back(n);
+    run_chunks(threads, [&sort_range, &bounds](unsigned t) {
+        sort_range(bounds[t], bounds[t + 1]);
+    });
+    // Close the gaps left by repeats, moving rows towards the front.
+    size_t position = 0;
+    for (unsigned i = 0; i < n; i++) {
+        size_t start = offsets[i];
+        offsets[i] = position;
+        if (position != start) {
+            copy(begin(neighbours) + start, begin(neighbours) + start + degrees[i],
+                 begin(neighbours) + position);
+        }
+        position += degrees[i];
+    }
+    offsets[n] = position;
+    if (position < neighbours.size()) {
+        neighbours.resize(position);
+        neighbours.shrink_to_fit();
+    }
+}
+
+
+void UndirectedGraph::build_matrix(Storage& storage) {
+    const unsigned n = storage.offsets.size() - 1;
+    storage.row_words = bitset_words(n);
+    storage.matrix.assign(n * storage.row_words, 0);
+    for (unsigned i = 0; i < n; i++) {
+        uint64_t* row = storage.matrix.data() + i * storage.row_words;
+        for (size_t k = storage.offsets[i]; k < storage.offsets[i + 1]; k++) {
+            set_bit(row, storage.neighbours[k]);
+        }
+    }
+}
+
+
+UndirectedGraph UndirectedGraph::read_dimacs(string file_name, unsigned threads) {
+    return parse_dimacs(MappedFile(file_name), file_name, threads);
+}
+
+
+UndirectedGraph UndirectedGraph::parse_dimacs(
+        const MappedFile& file, const string& file_name, unsigned threads) {
+    const char* position = file.begin();
+    const char* end = file.end();
+    unsigned vertices = 0;
+    uint64_t edges = 0;
+    bool found = false;
+    while (position != end && !found) {
+        const char* line = skip_blanks(position, end);
+        if (line != end && *line == 'p') {
+            // p <format> N M
+            const char* field = skip_blanks(line + 1, end);
+            while (field != end && !is_blank(*field) && *field != '\n') { field++; }
+            uint64_t n;
+            field = parse_number(field, end, &n);
+            field = parse_number(field, end, &edges);
+            if (field == nullptr || n > numeric_limits<unsigned>::max()) {
+                throw domain_error("Bad problem line in " + file_name + ".");
             }
+            vertices = n;
+            found = true;
         }
-    } else {
-        throw "File not open.";
+        position = next_line(line, end);
+    }
+    if (!found) {
+        throw domain_error("No problem line in " + file_name + ".");
+    }
+    if (threads == 0) {
+        threads = (file.size() >= parallel_parse_bytes)
+            ? max(1u, thread::hardware_concurrency()) : 1;
     }
-    if (edge_list.size() != edges) {
+    // Chunks start after a line break, so each holds whole lines.
+    vector<const char*> bounds{position};
+    for (unsigned c = 1; c < threads; c++) {
+        const char* bound = max(position + (end - position) * c / threads, bounds.back());
+        bounds.push_back((bound == position) ? bound : next_line(bound - 1, end));
+    }
+    bounds.push_back(end);
+    // Edge lines are counted on both passes; the count from the last is kept.
+    vector<uint64_t> lines(threads, 0);
+    auto for_each_edge = [&bounds, &lines, &file_name](unsigned c, auto add) {
+        const char* position = bounds[c];
+        const char* end = bounds[c + 1];
+        uint64_t count = 0;
+        while (position != end) {
+            const char* line = skip_blanks(position, end);
+            if (line != end && *line == 'e') {
+                uint64_t a, b;
+                const char* field = parse_number(line + 1, end, &a);
+                field = parse_number(field, end, &b);
+                if (field == nullptr || a == 0 || b == 0
+                        || a > numeric_limits<unsigned>::max()
+                        || b > numeric_limits<unsigned>::max()) {
+                    throw domain_error("Bad edge line in " + file_name + ".");
+                }
+                add(a - 1, b - 1);
+                count++;
+            }
+            position = next_line(line, end);
+        }
+        lines[c] = count;
+    };
+    auto graph = from_edge_chunks(vertices, threads, for_each_edge);
+    if (accumulate(std::begin(lines), std::end(lines), uint64_t(0)) != edges) {
         throw domain_error("Incorrect number of edges.");
     }
-    return UndirectedGraph(vertices, edge_list);
+    return graph;
+}
+
+
+void UndirectedGraph::write_binary(const string& file_name) const {
+    ofstream out(file_name, ios::binary);
+    const uint64_t n = vertices();
+    const uint64_t entries = _offsets[n];
+    const uint64_t row_words = has_matrix() ? _row_words : 0;
+    BinaryHeader header{binary_magic, binary_version, n, entries, row_words};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(_offsets), (n + 1) * sizeof(uint64_t));
+    out.write(reinterpret_cast<const char*>(_neighbours), entries * sizeof(unsigned));
+    const char padding[8] = {};
+    out.write(padding, aligned(entries * sizeof(unsigned)) - entries * sizeof(unsigned));
+    if (row_words > 0) {
+        out.write(reinterpret_cast<const char*>(_matrix), n * row_words * sizeof(uint64_t));
+    }
+    if (!out) {
+        throw runtime_error("Failed to write " + file_name + ".");
+    }
+}
+
+
+UndirectedGraph UndirectedGraph::read_binary(const string& file_name) {
+    return open_binary(make_shared<const MappedFile>(file_name), file_name);
+}
+
+
+UndirectedGraph UndirectedGraph::open_binary(
+        shared_ptr<const MappedFile> file, const string& file_name) {
+    BinaryHeader header;
+    if (file->size() < sizeof(header)) {
+        throw domain_error("Truncated binary graph " + file_name + ".");
+    }
+    memcpy(&header, file->begin(), sizeof(header));
+    if (header.magic != binary_magic) {
+        throw domain_error("Not a binary graph: " + file_name + ".");
+    }
+    if (header.version != binary_version) {
+        throw domain_error("Unsupported binary graph version in " + file_name + ".");
+    }
+    // Only the sizes are checked, which does not touch the arrays' pages.
+    const uint64_t n = header.vertices;
+    if (n > numeric_limits<unsigned>::max()
+            || (header.row_words != 0 && header.row_words != bitset_words(n))) {
+        throw domain_error("Bad binary graph header in " + file_name + ".");
+    }
+    const size_t offsets_at = sizeof(header);
+    const size_t neighbours_at = offsets_at + (n + 1) * sizeof(uint64_t);
+    const size_t matrix_at = neighbours_at + aligned(header.entries * sizeof(unsigned));
+    const size_t size = matrix_at + n * header.row_words * sizeof(uint64_t);
+    if (file->size() != size) {
+        throw domain_error("Bad binary graph size in " + file_name + ".");
+    }
+    UndirectedGraph graph;
+    graph._vertices = n;
+    graph._offsets = reinterpret_cast<const size_t*>(file->begin() + offsets_at);
+    graph._neighbours = reinterpret_cast<const unsigned*>(file->begin() + neighbours_at);
+    if (header.row_words > 0) {
+        graph._matrix = reinterpret_cast<const uint64_t*>(file->begin() + matrix_at);
+        graph._row_words = header.row_words;
+    }
+    if (graph._offsets[0] != 0 || graph._offsets[n] != header.entries) {
+        throw domain_error("Bad binary graph offsets in " + file_name + ".");
+    }
+    graph._owner = std::move(file);
+    return graph;
+}
+
+
+UndirectedGraph UndirectedGraph::read(const string& file_name) {
+    auto file = make_shared<const MappedFile>(file_name);
+    uint32_t magic = 0;
+    if (file->size() >= sizeof(magic)) { memcpy(&magic, file->begin(), sizeof(magic)); }
+    if (magic == binary_magic) {
+        return open_binary(std::move(file), file_name);
+    }
+    return parse_dimacs(*file, file_name, 0);
 }
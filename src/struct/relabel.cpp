@@ -0,0 +1,167 @@
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+#include <gsl/gsl_assert>
+
+#include "../../include/arbory/struct/relabel.hpp"
+
+using namespace std;
+
+
+namespace {
+
+vector<unsigned> identity(unsigned n) {
+    vector<unsigned> result(n);
+    iota(begin(result), end(result), 0);
+    return result;
+}
+
+// Smallest-last order (Matula & Beck), computed as the core decomposition of
+// Batagelj & Zaversnik in O(n + m): repeatedly remove a vertex of least
+// remaining degree, with degrees clamped at the current core number so that
+// vertices can stay in buckets. Each vertex has no more neighbours after it
+// in the order than its core number.
+vector<unsigned> smallest_last(const UndirectedGraph& graph) {
+    const unsigned n = graph.vertices();
+    vector<unsigned> degree(n);
+    unsigned max_degree = 0;
+    for (unsigned v = 0; v < n; v++) {
+        degree[v] = graph.degree(v);
+        max_degree = max(max_degree, degree[v]);
+    }
+    // vertices holds the vertices by remaining degree, starting at
+    // bucket_start[d] for degree d; position is the inverse of vertices.
+    vector<unsigned> bucket_start(max_degree + 2, 0);
+    for (unsigned v = 0; v < n; v++) { bucket_start[degree[v] + 1]++; }
+    partial_sum(begin(bucket_start), end(bucket_start), begin(bucket_start));
+    vector<unsigned> vertices(n), position(n);
+    {
+        auto next = bucket_start;
+        for (unsigned v = 0; v < n; v++) {
+            position[v] = next[degree[v]]++;
+            vertices[position[v]] = v;
+        }
+    }
+    // vertices[0, i) have been removed; the first remaining vertex has least
+    // degree, and removing it moves each remaining neighbour u down a bucket
+    // by swapping it to the front of its bucket.
+    for (unsigned i = 0; i < n; i++) {
+        unsigned v = vertices[i];
+        for (auto u : graph[v]) {
+            if (position[u] <= i || degree[u] <= degree[v]) { continue; }
+            unsigned d = degree[u];
+            unsigned first = max(bucket_start[d], i + 1);
+            unsigned w = vertices[first];
+            if (w != u) {
+                swap(vertices[position[u]], vertices[first]);
+                swap(position[u], position[w]);
+            }
+            bucket_start[d] = first + 1;
+            degree[u]--;
+        }
+    }
+    return vertices;
+}
+
+// Cuthill-McKee: breadth-first search of each component from a vertex of
+// least degree, visiting neighbours in order of increasing degree.
+vector<unsigned> cuthill_mckee(const UndirectedGraph& graph) {
+    const unsigned n = graph.vertices();
+    auto by_degree = [&graph](unsigned u, unsigned v) {
+        return make_pair(graph.degree(u), u) < make_pair(graph.degree(v), v);
+    };
+    auto starts = identity(n);
+    sort(begin(starts), end(starts), by_degree);
+    vector<bool> visited(n, false);
+    vector<unsigned> result;
+    result.reserve(n);
+    vector<unsigned> next;
+    for (auto start : starts) {
+        if (visited[start]) { continue; }
+        visited[start] = true;
+        // result doubles as the queue: [head, end) are yet to be expanded.
+        size_t head = result.size();
+        result.push_back(start);
+        for (; head < result.size(); head++) {
+            next.clear();
+            for (auto u : graph[result[head]]) {
+                if (!visited[u]) {
+                    visited[u] = true;
+                    next.push_back(u);
+                }
+            }
+            sort(begin(next), end(next), by_degree);
+            result.insert(end(result), begin(next), end(next));
+        }
+    }
+    return result;
+}
+
+// Copy of the graph with vertex order[k] numbered k.
+UndirectedGraph renumber(
+        const UndirectedGraph& graph, const vector<unsigned>& order, AdjacencyMatrix matrix) {
+    const unsigned n = graph.vertices();
+    Expects(order.size() == n);
+    const bool wants_matrix = (matrix == AdjacencyMatrix::Auto)
+        ? UndirectedGraph::prefers_matrix(n, graph.edges())
+        : (matrix == AdjacencyMatrix::Always);
+    const bool same_matrix = (graph.has_matrix() == wants_matrix);
+    if (same_matrix && is_sorted(begin(order), end(order))) {
+        return graph;   // Nothing changes: share the arrays.
+    }
+    vector<unsigned> renumbered(n, n);
+    for (unsigned k = 0; k < n; k++) {
+        Expects(order[k] < n && renumbered[order[k]] == n);
+        renumbered[order[k]] = k;
+    }
+    return UndirectedGraph::from_edges(n, [&graph, &order, &renumbered, n](auto add) {
+        for (unsigned k = 0; k < n; k++) {
+            for (auto u : graph[order[k]]) {
+                if (k < renumbered[u]) { add(k, renumbered[u]); }
+            }
+        }
+    }, matrix);
+}
+
+}  // namespace
+
+
+VertexOrder parse_vertex_order(const string& name) {
+    if (name == "input") { return VertexOrder::Input; }
+    if (name == "degree") { return VertexOrder::Degree; }
+    if (name == "degeneracy") { return VertexOrder::Degeneracy; }
+    if (name == "rcm") { return VertexOrder::ReverseCuthillMcKee; }
+    throw domain_error("Bad vertex order choice.");
+}
+
+
+vector<unsigned> vertex_order(const UndirectedGraph& graph, VertexOrder order) {
+    vector<unsigned> result;
+    switch (order) {
+    case VertexOrder::Input:
+        result = identity(graph.vertices());
+        break;
+    case VertexOrder::Degree:
+        result = identity(graph.vertices());
+        stable_sort(begin(result), end(result), [&graph](unsigned u, unsigned v) {
+            return graph.degree(u) > graph.degree(v);
+        });
+        break;
+    case VertexOrder::Degeneracy:
+        result = smallest_last(graph);
+        reverse(begin(result), end(result));
+        break;
+    case VertexOrder::ReverseCuthillMcKee:
+        result = cuthill_mckee(graph);
+        reverse(begin(result), end(result));
+        break;
+    }
+    Ensures(result.size() == graph.vertices());
+    return result;
+}
+
+
+RelabeledGraph::RelabeledGraph(
+        const UndirectedGraph& graph, vector<unsigned> order, AdjacencyMatrix matrix) :
+    _graph(renumber(graph, order, matrix)), _original(move(order)) {}